@@ -4,6 +4,8 @@
 #include "rice/Array.hpp"
 #include "rice/Enum.hpp"
 
+#include <ruby/thread.h>
+
 #include <stdint.h>
 #include <vector>
 #include <iostream>
@@ -100,15 +102,13 @@ Object to_ruby< ParameterVector >(const ParameterVector& v)
 template<>
 Object to_ruby< ByteVector >(const std::vector<uint8_t>& obj)
 {
-	Array bytes;
-        
-	int size = obj.size();
-	for( int i = 0; i < size; i++)
+	VALUE bytes = rb_ary_new2(obj.size());
+	for(size_t i = 0; i < obj.size(); i++)
 	{
-		bytes.push(obj[i]);
+		rb_ary_push(bytes, INT2FIX(obj[i]));
 	}
 
-	return bytes;
+	return Object(bytes);
 }
 
 template<>
@@ -116,7 +116,6 @@ ByteVector from_ruby< ByteVector >(Object obj)
 {
 	Data_Object< ByteVector> bytes(obj, byteVector);
 	return *bytes;
-	return *bytes;	
 }
 
 template<>
@@ -126,6 +125,160 @@ Object to_ruby< ConversationPtr >(const ConversationPtr& p)
     return conversation;
 }
 
+/**
+* Create a binary ruby string from the encoded data with a single copy
+*/
+Object toBinaryString(const std::string& data)
+{
+	return Object(rb_str_new(data.data(), data.size()));
+}
+
+/**
+* Copy the content of a ruby string, the only copy on the way from ruby to the parsers
+*/
+std::string fromBinaryString(Object byteString)
+{
+	VALUE value = byteString.value();
+	Check_Type(value, T_STRING);
+	return std::string(RSTRING_PTR(value), RSTRING_LEN(value));
+}
+
+/**
+* Encoding of messages or envelopes to bitefficient representation, called without
+* holding the GVL, so that it must neither touch ruby objects nor throw
+*/
+template<typename T>
+struct EncodeCall
+{
+	std::vector<const T*> objects;
+	std::vector<std::string> data;
+	std::string error;
+
+	void operator()();
+};
+
+template<>
+void EncodeCall<ACLMessage>::operator()()
+{
+	try {
+		data.resize(objects.size());
+		for(size_t i = 0; i < objects.size(); i++)
+		{
+			data[i] = MessageGenerator::create(*objects[i], representation::BITEFFICIENT);
+		}
+	} catch(const std::exception& e)
+	{
+		error = e.what();
+	}
+}
+
+template<>
+void EncodeCall<ACLEnvelope>::operator()()
+{
+	try {
+		data.resize(objects.size());
+		for(size_t i = 0; i < objects.size(); i++)
+		{
+			data[i] = EnvelopeGenerator::create(*objects[i], representation::BITEFFICIENT);
+		}
+	} catch(const std::exception& e)
+	{
+		error = e.what();
+	}
+}
+
+/**
+* Parsing of bitefficient messages or envelopes, called without holding the GVL
+*/
+template<typename T>
+struct DecodeCall
+{
+	std::vector<std::string> data;
+	std::vector<T> objects;
+	// Index of the first entry which could not be parsed, data.size() if all succeeded
+	size_t failed;
+
+	void operator()();
+};
+
+template<>
+void DecodeCall<ACLMessage>::operator()()
+{
+	objects.resize(data.size());
+	try {
+		for(failed = 0; failed < data.size(); failed++)
+		{
+			if(!MessageParser::parseData(data[failed], objects[failed], representation::BITEFFICIENT))
+			{
+				break;
+			}
+		}
+	} catch(const std::exception& e)
+	{
+		// failed remains at the entry which caused the exception
+	}
+}
+
+template<>
+void DecodeCall<ACLEnvelope>::operator()()
+{
+	objects.resize(data.size());
+	try {
+		for(failed = 0; failed < data.size(); failed++)
+		{
+			if(!EnvelopeParser::parseData(data[failed], objects[failed], representation::BITEFFICIENT))
+			{
+				break;
+			}
+		}
+	} catch(const std::exception& e)
+	{
+		// failed remains at the entry which caused the exception
+	}
+}
+
+template<typename Call>
+void* callWithoutGVL(void* call)
+{
+	(*static_cast<Call*>(call))();
+	return NULL;
+}
+
+/**
+* Run the call without the GVL, so that other ruby threads continue while it encodes or parses
+*/
+template<typename Call>
+void withoutGVL(Call& call)
+{
+	rb_thread_call_without_gvl(&callWithoutGVL<Call>, &call, NULL, NULL);
+}
+
+template<typename T>
+std::vector<std::string> encode(const std::vector<const T*>& objects, const std::string& name)
+{
+	EncodeCall<T> encoding;
+	encoding.objects = objects;
+	withoutGVL(encoding);
+	if(!encoding.error.empty())
+	{
+		throw std::runtime_error(name + ": " + encoding.error);
+	}
+	return encoding.data;
+}
+
+template<typename T>
+std::vector<T> decode(DecodeCall<T>& decoding, const std::string& name)
+{
+	withoutGVL(decoding);
+	if(decoding.failed != decoding.data.size())
+	{
+		char buffer[512];
+		snprintf(buffer, 512, "%s: data at index %lu could not be parsed", name.c_str(), decoding.failed);
+		throw std::runtime_error(buffer);
+	}
+	return decoding.objects;
+}
+
 // Convert std::vector<string> to ruby Array
 Array wrap_getAddresses(Object aid)
 {
@@ -166,22 +319,24 @@ Array wrap_getUserDefinedParameters(Object aid)
 
 Array wrap_toByteVector(Object message)
 {
-
    Data_Object<ACLMessage> msg(message, rb_cFipaMessage);
 
-   std::string bitefficientMsg = MessageGenerator::create(*msg, representation::BITEFFICIENT);
-   int size = bitefficientMsg.size();
+   std::vector<const ACLMessage*> messages(1, &*msg);
+   std::string data = encode(messages, "FIPA::ACLMessage").front();
+   return to_ruby<ByteVector>(ByteVector(data.begin(), data.end()));
+}
 
-   std::vector<uint8_t> bytes;
-   for(int i = 0; i < size; i++)
-   {
-       bytes.push_back(bitefficientMsg[i]);
-   } 
+/**
+* Encode the message into a binary string
+*/
+Object wrap_toByteString(Object message)
+{
+   Data_Object<ACLMessage> msg(message, rb_cFipaMessage);
 
-   return to_ruby<ByteVector>(bytes); 
+   std::vector<const ACLMessage*> messages(1, &*msg);
+   return toBinaryString(encode(messages, "FIPA::ACLMessage").front());
 }
 
-
 /**
 * Conversion of a string, that contains an array of bytes as core data into a FipaMessage
 * The array of bytes will be parsed in the message object
@@ -191,21 +346,52 @@ Object wrap_fromByteString(Object self, String byteString)
 {
 	Data_Object<ACLMessage> msg(self, rb_cFipaMessage);	
 
-	std::string data; 
-	int size = byteString.length();
+	DecodeCall<ACLMessage> decoding;
+	decoding.data.push_back(fromBinaryString(byteString));
+	*msg = decode(decoding, "FIPA::ACLMessage").front();
 
-	for(int i=0; i < size; i++)
+	return msg;
+}
+
+/**
+* Encode an array of messages into an array of binary strings
+*/
+Array wrap_encodeBatch(Object self, Array messages)
+{
+	std::vector<const ACLMessage*> objects;
+	for(size_t i = 0; i < messages.size(); i++)
 	{
-		data += (char) byteString[i];
+		Data_Object<ACLMessage> msg(messages[i], rb_cFipaMessage);
+		objects.push_back(&*msg);
 	}
 
-	MessageParser parser;
-	if(!parser.parseData(data, *msg))
+	std::vector<std::string> data = encode(objects, "FIPA::ACLMessage");
+	Array strings;
+	for(size_t i = 0; i < data.size(); i++)
 	{
-		throw std::runtime_error("FIPA::ACLMessage: data could not be parsed");
+		strings.push(toBinaryString(data[i]));
 	}
+	return strings;
+}
 
-	return msg;
+/**
+* Decode an array of binary strings into an array of messages
+*/
+Array wrap_decodeBatch(Object self, Array byteStrings)
+{
+	DecodeCall<ACLMessage> decoding;
+	for(size_t i = 0; i < byteStrings.size(); i++)
+	{
+		decoding.data.push_back(fromBinaryString(byteStrings[i]));
+	}
+
+	std::vector<ACLMessage> objects = decode(decoding, "FIPA::ACLMessage");
+	Array messages;
+	for(size_t i = 0; i < objects.size(); i++)
+	{
+		messages.push(Data_Object<ACLMessage>(new ACLMessage(objects[i]), rb_cFipaMessage));
+	}
+	return messages;
 }
 
 Object wrap_setPerformative(Object self, Symbol performative)
@@ -271,23 +457,24 @@ Object wrap_envelope_getFrom(Object self)
 
 Array wrap_envelope_toByteVector(Object self)
 {
-
    Data_Object<ACLEnvelope> envelope(self, rb_cFipaEnvelope);
 
-   std::string bitefficientEnvelope = EnvelopeGenerator::create(*envelope, representation::BITEFFICIENT);
-
-   int size = bitefficientEnvelope.size();
+   std::vector<const ACLEnvelope*> envelopes(1, &*envelope);
+   std::string data = encode(envelopes, "FIPA::ACLEnvelope").front();
+   return to_ruby<ByteVector>(ByteVector(data.begin(), data.end()));
+}
 
-   std::vector<uint8_t> bytes;
-   for(int i = 0; i < size; i++)
-   {
-       bytes.push_back(bitefficientEnvelope[i]);
-   } 
+/**
+* Encode the envelope into a binary string
+*/
+Object wrap_envelope_toByteString(Object self)
+{
+   Data_Object<ACLEnvelope> envelope(self, rb_cFipaEnvelope);
 
-   return to_ruby<ByteVector>(bytes); 
+   std::vector<const ACLEnvelope*> envelopes(1, &*envelope);
+   return toBinaryString(encode(envelopes, "FIPA::ACLEnvelope").front());
 }
 
-
 /**
 * Conversion of a string, that contains an array of bytes as core data into a FIPA::ACLEnvelope
 * The array of bytes will be parsed in the envelope object
@@ -297,21 +484,52 @@ Object wrap_envelope_fromByteString(Object self, String byteString)
 {
 	Data_Object<ACLEnvelope> envelope(self, rb_cFipaEnvelope);	
 
-	std::string data; 
-	int size = byteString.length();
+	DecodeCall<ACLEnvelope> decoding;
+	decoding.data.push_back(fromBinaryString(byteString));
+	*envelope = decode(decoding, "FIPA::ACLEnvelope").front();
+
+	return envelope;
+}
+
+/**
+* Encode an array of envelopes into an array of binary strings
+*/
+Array wrap_envelope_encodeBatch(Object self, Array envelopes)
+{
+	std::vector<const ACLEnvelope*> objects;
+	for(size_t i = 0; i < envelopes.size(); i++)
+	{
+		Data_Object<ACLEnvelope> envelope(envelopes[i], rb_cFipaEnvelope);
+		objects.push_back(&*envelope);
+	}
 
-	for(int i=0; i < size; i++)
+	std::vector<std::string> data = encode(objects, "FIPA::ACLEnvelope");
+	Array strings;
+	for(size_t i = 0; i < data.size(); i++)
 	{
-		data += (char) byteString[i];
+		strings.push(toBinaryString(data[i]));
 	}
+	return strings;
+}
 
-	EnvelopeParser parser;
-	if(!parser.parseData(data, *envelope, representation::BITEFFICIENT))
+/**
+* Decode an array of binary strings into an array of envelopes
+*/
+Array wrap_envelope_decodeBatch(Object self, Array byteStrings)
+{
+	DecodeCall<ACLEnvelope> decoding;
+	for(size_t i = 0; i < byteStrings.size(); i++)
 	{
-		throw std::runtime_error("FIPA::ACLEnvelope: data could not be parsed");
+		decoding.data.push_back(fromBinaryString(byteStrings[i]));
 	}
 
-	return envelope;
+	std::vector<ACLEnvelope> objects = decode(decoding, "FIPA::ACLEnvelope");
+	Array envelopes;
+	for(size_t i = 0; i < objects.size(); i++)
+	{
+		envelopes.push(Data_Object<ACLEnvelope>(new ACLEnvelope(objects[i]), rb_cFipaEnvelope));
+	}
+	return envelopes;
 }
 
 
@@ -396,6 +614,7 @@ void Init_fipamessage_ruby()
         .define_value("BITEFFICIENT",representation::BITEFFICIENT)
         .define_value("STRING",representation::STRING_REP)
         .define_value("XML", representation::XML)
+        .define_value("AUTO", representation::AUTO)
         ;
 
     rb_cFipaBaseEnvelope = define_class_under<ACLBaseEnvelope>(rb_mFIPA, "ACLBaseEnvelope")
@@ -424,7 +643,10 @@ void Init_fipamessage_ruby()
         .define_method("getFrom", &wrap_envelope_getFrom)
         .define_method("flattened", &ACLEnvelope::flattened)
         .define_method("to_byte_array", &wrap_envelope_toByteVector)
+        .define_method("to_byte_string", &wrap_envelope_toByteString)
         .define_method("from_byte_string", &wrap_envelope_fromByteString)
+        .define_singleton_method("encode_batch", &wrap_envelope_encodeBatch, Arg("envelopes"))
+        .define_singleton_method("decode_batch", &wrap_envelope_decodeBatch, Arg("byte_strings"))
         ;
 
     rb_cFipaMessage = define_class_under<ACLMessage>(rb_mFIPA, "ACLMessage")
@@ -442,7 +664,7 @@ void Init_fipamessage_ruby()
         .define_method("getEncoding", &ACLMessage::getEncoding)
         .define_method("setLanguage", &ACLMessage::setLanguage, Arg("language_name"))
         .define_method("getLanguage", &ACLMessage::getLanguage)
-        .define_method("setContent", &ACLMessage::setContent, Arg("content_string"))
+        .define_method("setContent", static_cast<void (ACLMessage::*)(const std::string&)>(&ACLMessage::setContent), Arg("content_string"))
         .define_method("getContent", &ACLMessage::getContent)
         .define_method("setSender", &ACLMessage::setSender, Arg("sender_name"))
         .define_method("getSender", &ACLMessage::getSender)
@@ -454,7 +676,10 @@ void Init_fipamessage_ruby()
         .define_method("setConversationID", &ACLMessage::setConversationID, Arg("conversation_id"))
         .define_method("getConversationID", &ACLMessage::getConversationID)
         .define_method("to_byte_array", &wrap_toByteVector)
+        .define_method("to_byte_string", &wrap_toByteString)
         .define_method("from_byte_string", &wrap_fromByteString)
+        .define_singleton_method("encode_batch", &wrap_encodeBatch, Arg("messages"))
+        .define_singleton_method("decode_batch", &wrap_decodeBatch, Arg("byte_strings"))
         .define_method("to_s", &ACLMessage::toString)
         //.define_method("setReplyBy",
         //.define_method("addUserDefinedParameter", &ACLMessage::addUserdefParam)
@@ -72,6 +72,41 @@ class FipaMessageTest < Test::Unit::TestCase
 	    assert_equal(msg_deserialized.getPerformative, performative)
 	end
 
+	def test_ByteString
+	    msg = ACLMessage.new
+	    msg.setProtocol "RIMRES"
+	    msg.setPerformative :inform
+	    msg.setContent "content"
+
+	    data = msg.to_byte_string
+	    assert_equal(Encoding::BINARY, data.encoding)
+	    assert_equal(msg.to_byte_array.pack("C*"), data)
+
+	    msg_deserialized = ACLMessage.new
+	    msg_deserialized.from_byte_string data
+	    assert_equal("content", msg_deserialized.getContent)
+	end
+
+	def test_Batch
+	    messages = (0...10).map do |i|
+	        msg = ACLMessage.new
+	        msg.setPerformative :inform
+	        msg.setContent "content-#{i}"
+	        msg
+	    end
+
+	    data = ACLMessage.encode_batch(messages)
+	    assert_equal(10, data.length)
+
+	    decoded = ACLMessage.decode_batch(data)
+	    assert_equal(10, decoded.length)
+	    decoded.each_with_index do |msg, i|
+	        assert_equal("content-#{i}", msg.getContent)
+	    end
+
+	    assert_raise(RuntimeError) { ACLMessage.decode_batch([data[0], "invalid"]) }
+	end
+
 	def test_Deserialization
 	    array = Array.new
 	    data = IO.read(File.join(File.dirname(__FILE__),"inform"))
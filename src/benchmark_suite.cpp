@@ -0,0 +1,673 @@
+/**
+ * \file benchmark_suite.cpp
+ * \brief Microbenchmarks of the encoders, parsers, the conversation monitor and agent id comparison
+ * \details Runs every benchmark over a generated corpus of messages and letters with varying number of receivers,
+ * user defined parameters, content size and envelope hops and reports per operation timing percentiles and
+ * allocation counts as JSON or CSV, so that results of different library versions can be compared
+ */
+#include <fipa_acl/fipa_acl.h>
+#include <fipa_acl/conversation_monitor/statemachine_factory.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <time.h>
+#include <new>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <boost/lexical_cast.hpp>
+
+// Count all heap allocations of this process, the benchmarks are run
+// single threaded so a plain counter suffices
+static unsigned long long msAllocations = 0;
+
+void* operator new(size_t size)
+{
+    ++msAllocations;
+    void* p = malloc(size ? size : 1);
+    if(!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* p) throw()
+{
+    free(p);
+}
+
+void operator delete[](void* p) throw()
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) throw()
+{
+    free(p);
+}
+
+void operator delete[](void* p, size_t) throw()
+{
+    free(p);
+}
+
+using namespace fipa::acl;
+
+namespace benchmark {
+
+/**
+ * Parameters of a generated message or letter
+ */
+struct CorpusEntry
+{
+    int receivers;
+    int userdefParams;
+    int contentSize;
+    int hops;
+
+    CorpusEntry(int receivers, int userdefParams, int contentSize, int hops)
+        : receivers(receivers)
+        , userdefParams(userdefParams)
+        , contentSize(contentSize)
+        , hops(hops)
+    {}
+};
+
+/**
+ * Result of a single benchmark run, all times in microseconds per operation
+ */
+struct Result
+{
+    std::string name;
+    std::string representation;
+    CorpusEntry entry;
+    size_t encodedSize;
+    size_t samples;
+    size_t opsPerSample;
+    double mean;
+    double p50;
+    double p90;
+    double p99;
+    double max;
+    double allocationsPerOp;
+
+    Result(const std::string& name, const std::string& representation, const CorpusEntry& entry)
+        : name(name)
+        , representation(representation)
+        , entry(entry)
+        , encodedSize(0)
+        , samples(0)
+        , opsPerSample(1)
+        , mean(0), p50(0), p90(0), p99(0), max(0)
+        , allocationsPerOp(0)
+    {}
+};
+
+struct Options
+{
+    std::string format;
+    std::string output;
+    std::string protocolDir;
+    std::string label;
+    size_t iterations;
+
+    Options()
+        : format("json")
+        , protocolDir("configuration/protocols")
+        , iterations(200)
+    {}
+};
+
+static double now()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1.0E6 + ts.tv_nsec/1.0E3;
+}
+
+/**
+ * Collects the timings of all samples of a benchmark
+ */
+class Recorder
+{
+public:
+    Recorder(size_t samples, size_t opsPerSample = 1)
+        : mOpsPerSample(opsPerSample)
+        , mAllocations(0)
+        , mStart(0)
+        , mAllocationsAtStart(0)
+    {
+        mSamples.reserve(samples);
+    }
+
+    void start()
+    {
+        mAllocationsAtStart = msAllocations;
+        mStart = now();
+    }
+
+    void stop()
+    {
+        double duration = now() - mStart;
+        mAllocations += msAllocations - mAllocationsAtStart;
+        mSamples.push_back(duration/mOpsPerSample);
+    }
+
+    void fill(Result& result)
+    {
+        result.samples = mSamples.size();
+        result.opsPerSample = mOpsPerSample;
+        if(mSamples.empty())
+        {
+            return;
+        }
+
+        std::sort(mSamples.begin(), mSamples.end());
+        double sum = 0;
+        std::vector<double>::const_iterator it = mSamples.begin();
+        for(; it != mSamples.end(); ++it)
+        {
+            sum += *it;
+        }
+        result.mean = sum/mSamples.size();
+        result.p50 = percentile(0.5);
+        result.p90 = percentile(0.9);
+        result.p99 = percentile(0.99);
+        result.max = mSamples.back();
+        result.allocationsPerOp = mAllocations/static_cast<double>(mSamples.size()*mOpsPerSample);
+    }
+
+private:
+    // Nearest rank on the sorted samples
+    double percentile(double p) const
+    {
+        size_t rank = static_cast<size_t>(p*mSamples.size());
+        return mSamples[std::min(rank, mSamples.size() - 1)];
+    }
+
+    std::vector<double> mSamples;
+    size_t mOpsPerSample;
+    unsigned long long mAllocations;
+    double mStart;
+    unsigned long long mAllocationsAtStart;
+};
+
+/**
+ * Create a message for the given corpus entry, content is filled from a fixed seed
+ * so that runs are comparable
+ */
+static ACLMessage createMessage(const CorpusEntry& entry, unsigned int seed)
+{
+    srand(seed);
+
+    ACLMessage msg(ACLMessage::INFORM);
+    AgentID sender("benchmark-sender");
+    sender.addAddress("tcp://127.0.0.1:12345");
+    sender.addResolver(AgentID("benchmark-resolver"));
+    msg.setSender(sender);
+    msg.addReplyTo(sender);
+
+    for(int i = 0; i < entry.receivers; ++i)
+    {
+        AgentID receiver("benchmark-receiver-" + boost::lexical_cast<std::string>(i));
+        receiver.addAddress("tcp://127.0.0.1:" + boost::lexical_cast<std::string>(20000 + i));
+        msg.addReceiver(receiver);
+    }
+
+    for(int i = 0; i < entry.userdefParams; ++i)
+    {
+        UserdefParam param;
+        param.setName("param-" + boost::lexical_cast<std::string>(i));
+        param.setValue("value-" + boost::lexical_cast<std::string>(rand()));
+        msg.addUserdefParam(param);
+    }
+
+    msg.setProtocol("inform");
+    msg.setLanguage("benchmark-language");
+    msg.setEncoding("benchmark-encoding");
+    msg.setOntology("benchmark-ontology");
+    msg.setReplyWith("benchmark-reply-with");
+    msg.setInReplyTo("benchmark-in-reply-to");
+    msg.setConversationID("benchmark-conversation");
+    msg.setReplyBy(base::Time::fromString("20101223-12:00:37:980", base::Time::Milliseconds));
+
+    // Printable content only, since the string representation requires it
+    std::string content(entry.contentSize, ' ');
+    for(int i = 0; i < entry.contentSize; ++i)
+    {
+        content[i] = 'a' + rand() % 26;
+    }
+    msg.setContent(content);
+    return msg;
+}
+
+static ACLEnvelope createEnvelope(const CorpusEntry& entry, unsigned int seed)
+{
+    ACLMessage msg = createMessage(entry, seed);
+    ACLEnvelope envelope(msg, representation::BITEFFICIENT);
+    for(int i = 0; i < entry.hops; ++i)
+    {
+        envelope.stamp(AgentID("benchmark-mts-" + boost::lexical_cast<std::string>(i)));
+    }
+    return envelope;
+}
+
+static std::vector<CorpusEntry> createMessageCorpus()
+{
+    std::vector<CorpusEntry> corpus;
+    int receivers[] = { 1, 16, 128 };
+    int userdefParams[] = { 0, 16 };
+    int contentSizes[] = { 0, 1024, 65536 };
+    for(size_t r = 0; r < sizeof(receivers)/sizeof(int); ++r)
+    {
+        for(size_t p = 0; p < sizeof(userdefParams)/sizeof(int); ++p)
+        {
+            for(size_t c = 0; c < sizeof(contentSizes)/sizeof(int); ++c)
+            {
+                corpus.push_back(CorpusEntry(receivers[r], userdefParams[p], contentSizes[c], 0));
+            }
+        }
+    }
+    return corpus;
+}
+
+static std::vector<CorpusEntry> createEnvelopeCorpus()
+{
+    std::vector<CorpusEntry> corpus;
+    int receivers[] = { 1, 16 };
+    int hops[] = { 0, 4, 16 };
+    for(size_t r = 0; r < sizeof(receivers)/sizeof(int); ++r)
+    {
+        for(size_t h = 0; h < sizeof(hops)/sizeof(int); ++h)
+        {
+            corpus.push_back(CorpusEntry(receivers[r], 0, 1024, hops[h]));
+        }
+    }
+    return corpus;
+}
+
+// Large inputs take milliseconds per operation, so reduce the number of samples for them
+static size_t scaledIterations(const Options& options, const CorpusEntry& entry)
+{
+    if(entry.contentSize >= 65536 || entry.receivers >= 128)
+    {
+        return std::max(options.iterations/10, static_cast<size_t>(10));
+    }
+    return options.iterations;
+}
+
+static void benchmarkMessages(const Options& options, std::vector<Result>& results)
+{
+    std::vector<CorpusEntry> corpus = createMessageCorpus();
+    representation::Type types[] = { representation::BITEFFICIENT, representation::STRING_REP, representation::XML };
+
+    std::vector<CorpusEntry>::const_iterator it = corpus.begin();
+    for(; it != corpus.end(); ++it)
+    {
+        ACLMessage msg = createMessage(*it, 42);
+        size_t iterations = scaledIterations(options, *it);
+
+        for(size_t t = 0; t < sizeof(types)/sizeof(representation::Type); ++t)
+        {
+            representation::Type type = types[t];
+            std::string encoded = MessageGenerator::create(msg, type);
+
+            Result encode("message-encode", representation::TypeTxt[type], *it);
+            encode.encodedSize = encoded.size();
+            Recorder encodeRecorder(iterations);
+            for(size_t i = 0; i < iterations; ++i)
+            {
+                encodeRecorder.start();
+                std::string data = MessageGenerator::create(msg, type);
+                encodeRecorder.stop();
+            }
+            encodeRecorder.fill(encode);
+            results.push_back(encode);
+
+            Result decode("message-decode", representation::TypeTxt[type], *it);
+            decode.encodedSize = encoded.size();
+            Recorder decodeRecorder(iterations);
+            for(size_t i = 0; i < iterations; ++i)
+            {
+                ACLMessage decoded;
+                decodeRecorder.start();
+                bool success = MessageParser::parseData(encoded, decoded, type);
+                decodeRecorder.stop();
+                if(!success)
+                {
+                    throw std::runtime_error("benchmark: decoding of message failed for representation " + representation::TypeTxt[type]);
+                }
+            }
+            decodeRecorder.fill(decode);
+            results.push_back(decode);
+        }
+    }
+}
+
+static void benchmarkEnvelopes(const Options& options, std::vector<Result>& results)
+{
+    std::vector<CorpusEntry> corpus = createEnvelopeCorpus();
+    representation::Type types[] = { representation::BITEFFICIENT, representation::XML };
+
+    std::vector<CorpusEntry>::const_iterator it = corpus.begin();
+    for(; it != corpus.end(); ++it)
+    {
+        ACLEnvelope envelope = createEnvelope(*it, 42);
+        size_t iterations = scaledIterations(options, *it);
+
+        for(size_t t = 0; t < sizeof(types)/sizeof(representation::Type); ++t)
+        {
+            representation::Type type = types[t];
+            std::string encoded = EnvelopeGenerator::create(envelope, type);
+
+            Result encode("envelope-encode", representation::TypeTxt[type], *it);
+            encode.encodedSize = encoded.size();
+            Recorder encodeRecorder(iterations);
+            for(size_t i = 0; i < iterations; ++i)
+            {
+                encodeRecorder.start();
+                std::string data = EnvelopeGenerator::create(envelope, type);
+                encodeRecorder.stop();
+            }
+            encodeRecorder.fill(encode);
+            results.push_back(encode);
+
+            Result decode("envelope-decode", representation::TypeTxt[type], *it);
+            decode.encodedSize = encoded.size();
+            Recorder decodeRecorder(iterations);
+            for(size_t i = 0; i < iterations; ++i)
+            {
+                ACLEnvelope decoded;
+                decodeRecorder.start();
+                bool success = EnvelopeParser::parseData(encoded, decoded, type);
+                decodeRecorder.stop();
+                if(!success)
+                {
+                    throw std::runtime_error("benchmark: decoding of envelope failed for representation " + representation::TypeTxt[type]);
+                }
+            }
+            decodeRecorder.fill(decode);
+            results.push_back(decode);
+        }
+    }
+}
+
+/**
+ * Time the update of the conversation monitor by the three messages
+ * of a complete request protocol conversation
+ */
+static void benchmarkConversationMonitor(const Options& options, std::vector<Result>& results)
+{
+    AgentID initiator("benchmark-initiator");
+    AgentID responder("benchmark-responder");
+    ConversationMonitor monitor(initiator, options.protocolDir);
+
+    ACLMessage request(ACLMessage::REQUEST);
+    request.setSender(initiator);
+    request.addReceiver(responder);
+    request.setProtocol("request");
+
+    ACLMessage agree(ACLMessage::AGREE);
+    agree.setSender(responder);
+    agree.addReceiver(initiator);
+    agree.setProtocol("request");
+
+    ACLMessage inform(ACLMessage::INFORM);
+    inform.setSender(responder);
+    inform.addReceiver(initiator);
+    inform.setProtocol("request");
+
+    Result result("conversation-monitor-update", "", CorpusEntry(1, 0, 0, 0));
+    Recorder recorder(options.iterations, 3);
+    for(size_t i = 0; i < options.iterations; ++i)
+    {
+        std::string conversationId = "benchmark-conversation-" + boost::lexical_cast<std::string>(i);
+        request.setConversationID(conversationId);
+        agree.setConversationID(conversationId);
+        inform.setConversationID(conversationId);
+
+        recorder.start();
+        monitor.getOrCreateConversation(conversationId);
+        monitor.updateConversation(request);
+        monitor.updateConversation(agree);
+        monitor.updateConversation(inform);
+        recorder.stop();
+
+        monitor.cleanup();
+    }
+    recorder.fill(result);
+    results.push_back(result);
+}
+
+/**
+ * Time the loading of all protocol definitions from the protocol directory
+ */
+static void benchmarkStateMachineFactory(const Options& options, std::vector<Result>& results)
+{
+    size_t iterations = std::max(options.iterations/10, static_cast<size_t>(10));
+    Result result("statemachine-factory-load", "", CorpusEntry(0, 0, 0, 0));
+    Recorder recorder(iterations);
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        recorder.start();
+        // Resetting the directory forces a reload with the next request of a state machine
+        StateMachineFactory::setProtocolResourceDir(options.protocolDir);
+        StateMachineFactory::getStateMachine("request");
+        recorder.stop();
+    }
+    recorder.fill(result);
+    results.push_back(result);
+}
+
+/**
+ * Time equality and ordering of agent ids, batched since a single
+ * comparison is below the resolution of the clock
+ */
+static void benchmarkAgentIDComparison(const Options& options, std::vector<Result>& results)
+{
+    const size_t batch = 1000;
+    AgentID a("benchmark-agent");
+    a.addAddress("tcp://127.0.0.1:12345");
+    a.addResolver(AgentID("benchmark-resolver"));
+    AgentID equal = a;
+    AgentID other("benchmark-agent-other");
+
+    size_t matches = 0;
+
+    Result equality("agentid-compare-equal", "", CorpusEntry(0, 0, 0, 0));
+    Recorder equalityRecorder(options.iterations, batch);
+    for(size_t i = 0; i < options.iterations; ++i)
+    {
+        equalityRecorder.start();
+        for(size_t b = 0; b < batch; ++b)
+        {
+            matches += (a == equal);
+            matches += (a == other);
+        }
+        equalityRecorder.stop();
+    }
+    equalityRecorder.fill(equality);
+    results.push_back(equality);
+
+    Result ordering("agentid-compare-less", "", CorpusEntry(0, 0, 0, 0));
+    Recorder orderingRecorder(options.iterations, batch);
+    for(size_t i = 0; i < options.iterations; ++i)
+    {
+        orderingRecorder.start();
+        for(size_t b = 0; b < batch; ++b)
+        {
+            matches += (a < other);
+            matches += (other < equal);
+        }
+        orderingRecorder.stop();
+    }
+    orderingRecorder.fill(ordering);
+    results.push_back(ordering);
+
+    // Prevent the comparisons from being optimized away
+    if(matches == 0)
+    {
+        fprintf(stderr, "benchmark: unexpected result of agent id comparison\n");
+    }
+}
+
+static void writeCSV(std::ostream& out, const Options& options, const std::vector<Result>& results)
+{
+    out << "label,benchmark,representation,receivers,userdef_params,content_size,hops,encoded_size,samples,ops_per_sample,"
+        << "mean_us,p50_us,p90_us,p99_us,max_us,allocations_per_op" << std::endl;
+
+    std::vector<Result>::const_iterator it = results.begin();
+    for(; it != results.end(); ++it)
+    {
+        out << options.label << ","
+            << it->name << ","
+            << it->representation << ","
+            << it->entry.receivers << ","
+            << it->entry.userdefParams << ","
+            << it->entry.contentSize << ","
+            << it->entry.hops << ","
+            << it->encodedSize << ","
+            << it->samples << ","
+            << it->opsPerSample << ","
+            << it->mean << ","
+            << it->p50 << ","
+            << it->p90 << ","
+            << it->p99 << ","
+            << it->max << ","
+            << it->allocationsPerOp << std::endl;
+    }
+}
+
+static void writeJSON(std::ostream& out, const Options& options, const std::vector<Result>& results)
+{
+    out << "{" << std::endl;
+    out << "  \"label\": \"" << options.label << "\"," << std::endl;
+    out << "  \"unit\": \"us\"," << std::endl;
+    out << "  \"results\": [" << std::endl;
+
+    std::vector<Result>::const_iterator it = results.begin();
+    for(; it != results.end(); ++it)
+    {
+        out << "    { "
+            << "\"benchmark\": \"" << it->name << "\", "
+            << "\"representation\": \"" << it->representation << "\", "
+            << "\"receivers\": " << it->entry.receivers << ", "
+            << "\"userdef_params\": " << it->entry.userdefParams << ", "
+            << "\"content_size\": " << it->entry.contentSize << ", "
+            << "\"hops\": " << it->entry.hops << ", "
+            << "\"encoded_size\": " << it->encodedSize << ", "
+            << "\"samples\": " << it->samples << ", "
+            << "\"ops_per_sample\": " << it->opsPerSample << ", "
+            << "\"mean\": " << it->mean << ", "
+            << "\"p50\": " << it->p50 << ", "
+            << "\"p90\": " << it->p90 << ", "
+            << "\"p99\": " << it->p99 << ", "
+            << "\"max\": " << it->max << ", "
+            << "\"allocations_per_op\": " << it->allocationsPerOp
+            << " }" << (it + 1 != results.end() ? "," : "") << std::endl;
+    }
+
+    out << "  ]" << std::endl;
+    out << "}" << std::endl;
+}
+
+} // end namespace benchmark
+
+void usage(const char* name)
+{
+    printf("usage: %s [-f json|csv] [-n <iterations>] [-p <protocol-dir>] [-o <output-file>] [-l <label>]\n", name);
+    printf("    -f  output format, default: json\n");
+    printf("    -n  number of samples per benchmark, reduced for large inputs, default: 200\n");
+    printf("    -p  directory of the protocol definitions, default: configuration/protocols\n");
+    printf("    -o  write results to file instead of stdout\n");
+    printf("    -l  label of this run, e.g. the library version, which is added to the results\n");
+}
+
+int main(int argc, char** argv)
+{
+    benchmark::Options options;
+
+    int option;
+    while( (option = getopt(argc, argv, "hf:n:p:o:l:")) != -1 )
+    {
+        switch(option)
+        {
+            case 'f':
+                options.format = optarg;
+                break;
+            case 'n':
+                options.iterations = atoi(optarg);
+                break;
+            case 'p':
+                options.protocolDir = optarg;
+                break;
+            case 'o':
+                options.output = optarg;
+                break;
+            case 'l':
+                options.label = optarg;
+                break;
+            case 'h':
+            default:
+                usage(argv[0]);
+                exit(0);
+        }
+    }
+
+    if(options.format != "json" && options.format != "csv")
+    {
+        usage(argv[0]);
+        exit(1);
+    }
+
+    if(options.iterations == 0)
+    {
+        options.iterations = 1;
+    }
+
+    // Benchmark the parsers, not the limit checks
+    ParserLimits::setDefault(ParserLimits::unlimited());
+
+    std::vector<benchmark::Result> results;
+    try {
+        benchmark::benchmarkMessages(options, results);
+        benchmark::benchmarkEnvelopes(options, results);
+        benchmark::benchmarkConversationMonitor(options, results);
+        benchmark::benchmarkStateMachineFactory(options, results);
+        benchmark::benchmarkAgentIDComparison(options, results);
+    } catch(const std::exception& e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    std::ofstream file;
+    if(!options.output.empty())
+    {
+        file.open(options.output.c_str());
+        if(!file.is_open())
+        {
+            fprintf(stderr, "benchmark: could not open output file '%s'\n", options.output.c_str());
+            return 1;
+        }
+    }
+    std::ostream& out = options.output.empty() ? std::cout : file;
+
+    if(options.format == "csv")
+    {
+        benchmark::writeCSV(out, options, results);
+    } else {
+        benchmark::writeJSON(out, options, results);
+    }
+
+    return 0;
+}
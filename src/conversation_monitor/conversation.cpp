@@ -1,5 +1,5 @@
 #include "conversation.h"
-#include <uuid/uuid.h>
+#include <fipa_acl/message_generator/id_generator.h>
 #include <base/Logging.hpp>
 #include <boost/regex.hpp>
 
@@ -206,14 +206,23 @@ void Conversation::update(const fipa::acl::ACLMessage& msg)
         }
 
         // update the message state machine
+        std::string error;
         try {
-            mStateMachine.consumeMessage(msg);
+            if(!mStateMachine.tryConsumeMessage(msg))
+            {
+                error = "Message does not trigger any (incl. proxied) transitions in this state";
+            }
         } catch(const std::runtime_error& e)
+        {
+            error = e.what();
+        }
+
+        if(!error.empty())
         {
             std::string errorMsg = "Conversation: unexpected message with performative '" + msg.getPerformative() + "' for the protocol '" + msg.getProtocol() + "' ";
             errorMsg += " current state: '" + mStateMachine.getCurrentStateId() + "',";
             errorMsg += " role mapping -- " + mStateMachine.getRoleMapping().toString();
-            errorMsg += " -- " + std::string(e.what()) + "\n";
+            errorMsg += " -- " + error + "\n";
             throw conversation::ProtocolException(errorMsg);
         }
 
@@ -284,12 +293,7 @@ std::string Conversation::getOwner() const
 
 fipa::acl::ConversationID Conversation::generateConversationID(const std::string& topic)
 {
-    uuid_t uuid;
-    uuid_generate(uuid);
-
-    char conversationId[37];
-    uuid_unparse(uuid, conversationId);
-    return std::string(conversationId) + "--" + topic + "--" + base::Time::now().toString();
+    return IDGenerator::createId() + "--" + topic;
 }
 
 std::string Conversation::toString(const std::vector<fipa::acl::ACLMessage>& messages)
@@ -350,6 +350,8 @@ public:
 
     /**
      * Create a new ConversationID
+     * <process prefix>-<counter>--<topic>
+     * \see IDGenerator
      */
     static fipa::acl::ConversationID generateConversationID(const std::string& topic = "");
 
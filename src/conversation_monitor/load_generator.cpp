@@ -0,0 +1,478 @@
+/**
+ * \file load_generator.cpp
+ * \brief Load generator for the conversation monitor
+ * \details Synthesizes conversations for the interaction protocols, or replays a captured
+ * stream of serialized letters, and drives a single ConversationMonitor from multiple threads.
+ * Reports update throughput, update latency and peak resident memory.
+ *
+ * A capture is a sequence of records: 1 byte representation type, 4 byte payload length
+ * (big endian) and the encoded letter. Captures can be created with the -w option.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <fstream>
+#include <boost/thread.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/functional/hash.hpp>
+#include <fipa_acl/fipa_acl.h>
+#include <fipa_acl/conversation_monitor/statemachine_factory.h>
+
+using namespace fipa::acl;
+
+namespace load {
+
+/**
+ * Messages of a single conversation in the order they are sent
+ */
+struct Scenario
+{
+    std::string protocol;
+    std::vector<ACLMessage> messages;
+    // Index of the message which violates the protocol, -1 if all messages are valid
+    int invalidIndex;
+
+    Scenario()
+        : invalidIndex(-1)
+    {}
+};
+
+struct Statistics
+{
+    std::vector<double> latencies;
+    size_t accepted;
+    size_t rejected;
+    // Rejected messages of valid conversations, or accepted protocol violations
+    size_t unexpected;
+
+    Statistics()
+        : accepted(0)
+        , rejected(0)
+        , unexpected(0)
+    {}
+};
+
+struct Options
+{
+    std::string protocolDir;
+    std::string replayFile;
+    std::string recordFile;
+    size_t conversations;
+    size_t threads;
+    size_t window;
+    int invalidPercent;
+    unsigned int seed;
+
+    Options()
+        : protocolDir("configuration/protocols")
+        , conversations(1000)
+        , threads(4)
+        , window(16)
+        , invalidPercent(0)
+        , seed(42)
+    {}
+};
+
+static double now()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1.0E6 + ts.tv_nsec/1.0E3;
+}
+
+/**
+ * Protocol flow between an initiator and a single responder (B)
+ */
+struct Step
+{
+    const char* performative;
+    bool fromInitiator;
+};
+
+struct ProtocolScript
+{
+    const char* protocol;
+    Step steps[6];
+    size_t size;
+};
+
+static const ProtocolScript msScripts[] = {
+    { "request",             { {"request", true}, {"agree", false}, {"inform", false} }, 3 },
+    { "query",               { {"query-ref", true}, {"agree", false}, {"inform-ref", false} }, 3 },
+    { "contractNet",         { {"cfp", true}, {"propose", false}, {"accept-proposal", true}, {"inform", false} }, 4 },
+    { "iteratedContractNet", { {"cfp", true}, {"propose", false}, {"cfp", true}, {"propose", false}, {"accept-proposal", true}, {"inform", false} }, 6 },
+    { "brokering",           { {"proxy", true}, {"agree", false}, {"inform", false} }, 3 },
+    { "dutchAuction",        { {"inform", true}, {"cfp", true}, {"propose", false}, {"accept-proposal", true}, {"inform", true} }, 5 },
+    { "subscribe",           { {"subscribe", true}, {"agree", false} }, 2 }
+};
+
+static const size_t msNumberOfScripts = sizeof(msScripts)/sizeof(ProtocolScript);
+
+static Scenario createScenario(size_t index, bool invalid, unsigned int* seed)
+{
+    const ProtocolScript& script = msScripts[index % msNumberOfScripts];
+    std::string id = boost::lexical_cast<std::string>(index);
+    std::string conversationId = std::string("load-") + script.protocol + "-" + id;
+    AgentID initiator("initiator-" + id);
+    AgentID responder("responder-" + id);
+
+    Scenario scenario;
+    scenario.protocol = script.protocol;
+    for(size_t i = 0; i < script.size; ++i)
+    {
+        const Step& step = script.steps[i];
+        ACLMessage msg(std::string(step.performative));
+        msg.setProtocol(script.protocol);
+        msg.setConversationID(conversationId);
+        msg.setSender(step.fromInitiator ? initiator : responder);
+        msg.addReceiver(step.fromInitiator ? responder : initiator);
+        msg.setContent("load generator message " + boost::lexical_cast<std::string>(i));
+        scenario.messages.push_back(msg);
+    }
+
+    if(invalid)
+    {
+        // Replace a response with a performative no protocol allows at this point
+        size_t position = 1 + rand_r(seed) % (script.size - 1);
+        ACLMessage& msg = scenario.messages[position];
+        msg.setPerformative(ACLMessage::PROPAGATE);
+        scenario.invalidIndex = position;
+    }
+    return scenario;
+}
+
+static std::vector<Scenario> createScenarios(const Options& options)
+{
+    unsigned int seed = options.seed;
+    std::vector<Scenario> scenarios;
+    scenarios.reserve(options.conversations);
+    for(size_t i = 0; i < options.conversations; ++i)
+    {
+        bool invalid = static_cast<int>(rand_r(&seed) % 100) < options.invalidPercent;
+        scenarios.push_back(createScenario(i, invalid, &seed));
+    }
+    return scenarios;
+}
+
+static void writeUInt32(std::ostream& out, uint32_t value)
+{
+    char buffer[4] = { char(value >> 24), char(value >> 16), char(value >> 8), char(value) };
+    out.write(buffer, 4);
+}
+
+static bool readUInt32(std::istream& in, uint32_t& value)
+{
+    unsigned char buffer[4];
+    if(!in.read(reinterpret_cast<char*>(buffer), 4))
+    {
+        return false;
+    }
+    value = (buffer[0] << 24) | (buffer[1] << 16) | (buffer[2] << 8) | buffer[3];
+    return true;
+}
+
+/**
+ * Write the messages of all scenarios as bitefficient letters, interleaving the
+ * conversations in the same way the driver does with a single thread
+ */
+static void record(const std::vector<Scenario>& scenarios, const Options& options)
+{
+    std::ofstream out(options.recordFile.c_str(), std::ios::binary);
+    if(!out.is_open())
+    {
+        throw std::runtime_error("load generator: could not open '" + options.recordFile + "' for writing");
+    }
+
+    for(size_t begin = 0; begin < scenarios.size(); begin += options.window)
+    {
+        size_t end = std::min(begin + options.window, scenarios.size());
+        for(size_t step = 0; ; ++step)
+        {
+            bool sent = false;
+            for(size_t i = begin; i < end; ++i)
+            {
+                if(step < scenarios[i].messages.size())
+                {
+                    ACLEnvelope envelope(scenarios[i].messages[step], representation::BITEFFICIENT);
+                    std::string data = EnvelopeGenerator::create(envelope, representation::BITEFFICIENT);
+                    out.put(static_cast<char>(representation::BITEFFICIENT));
+                    writeUInt32(out, data.size());
+                    out.write(data.data(), data.size());
+                    sent = true;
+                }
+            }
+            if(!sent)
+            {
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * Read a capture and group the messages by conversation, keeping their order
+ */
+static std::vector<Scenario> replay(const Options& options, double& decodingTime)
+{
+    std::ifstream in(options.replayFile.c_str(), std::ios::binary);
+    if(!in.is_open())
+    {
+        throw std::runtime_error("load generator: could not open '" + options.replayFile + "'");
+    }
+
+    std::vector<Scenario> scenarios;
+    std::map<std::string, size_t> conversations;
+    decodingTime = 0;
+
+    char type;
+    while(in.get(type))
+    {
+        uint32_t size;
+        if(!readUInt32(in, size))
+        {
+            throw std::runtime_error("load generator: truncated record in '" + options.replayFile + "'");
+        }
+        std::string data(size, '\0');
+        if(size && !in.read(&data[0], size))
+        {
+            throw std::runtime_error("load generator: truncated record in '" + options.replayFile + "'");
+        }
+
+        double start = now();
+        ACLEnvelope envelope;
+        if(!EnvelopeParser::parseData(data, envelope, static_cast<representation::Type>(type)))
+        {
+            fprintf(stderr, "load generator: skipping letter which could not be decoded\n");
+            continue;
+        }
+        ACLMessage msg = envelope.getACLMessage();
+        decodingTime += now() - start;
+
+        std::map<std::string, size_t>::iterator it = conversations.find(msg.getConversationID());
+        if(it == conversations.end())
+        {
+            it = conversations.insert(std::make_pair(msg.getConversationID(), scenarios.size())).first;
+            scenarios.push_back(Scenario());
+            scenarios.back().protocol = msg.getProtocol();
+        }
+        scenarios[it->second].messages.push_back(msg);
+    }
+    return scenarios;
+}
+
+/**
+ * Drive the monitor with the scenarios assigned to one thread: a window of conversations
+ * is active at the same time, and each of them advances by one message in turn
+ */
+static void drive(ConversationMonitor* monitor, const std::vector<const Scenario*>* scenarios, size_t window, Statistics* statistics)
+{
+    for(size_t begin = 0; begin < scenarios->size(); begin += window)
+    {
+        size_t end = std::min(begin + window, scenarios->size());
+        for(size_t step = 0; ; ++step)
+        {
+            bool sent = false;
+            for(size_t i = begin; i < end; ++i)
+            {
+                const Scenario& scenario = *(*scenarios)[i];
+                if(step >= scenario.messages.size())
+                {
+                    continue;
+                }
+
+                const ACLMessage& msg = scenario.messages[step];
+                bool accepted = true;
+                double start = now();
+                try {
+                    monitor->getOrCreateConversation(msg.getConversationID());
+                    monitor->updateConversation(msg);
+                } catch(const std::exception& e)
+                {
+                    accepted = false;
+                }
+                statistics->latencies.push_back(now() - start);
+                sent = true;
+
+                if(accepted)
+                {
+                    ++statistics->accepted;
+                } else {
+                    ++statistics->rejected;
+                }
+
+                // Messages following a protocol violation are not checked
+                bool afterViolation = scenario.invalidIndex >= 0 && static_cast<int>(step) > scenario.invalidIndex;
+                bool violation = scenario.invalidIndex == static_cast<int>(step);
+                if(!afterViolation && accepted == violation)
+                {
+                    ++statistics->unexpected;
+                }
+
+                if(step + 1 == scenario.messages.size())
+                {
+                    monitor->removeConversation(msg.getConversationID());
+                }
+            }
+            if(!sent)
+            {
+                break;
+            }
+        }
+    }
+}
+
+static double percentile(const std::vector<double>& sorted, double p)
+{
+    if(sorted.empty())
+    {
+        return 0;
+    }
+    size_t rank = static_cast<size_t>(p*sorted.size());
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+} // end namespace load
+
+void usage(const char* name)
+{
+    printf("usage: %s [-n <conversations>] [-t <threads>] [-i <invalid-percent>] [-p <protocol-dir>] [-r <capture> | -w <capture>]\n", name);
+    printf("    -n  number of synthesized conversations, default: 1000\n");
+    printf("    -t  number of threads updating the monitor, default: 4\n");
+    printf("    -c  number of conversations a thread interleaves, default: 16\n");
+    printf("    -i  percentage of conversations with a protocol violation, default: 0\n");
+    printf("    -s  seed of the generator, default: 42\n");
+    printf("    -p  directory of the protocol definitions, default: configuration/protocols\n");
+    printf("    -r  replay the letters of a capture instead of synthesizing conversations\n");
+    printf("    -w  write the synthesized conversations as capture\n");
+}
+
+int main(int argc, char** argv)
+{
+    load::Options options;
+
+    int option;
+    while( (option = getopt(argc, argv, "hn:t:c:i:s:p:r:w:")) != -1 )
+    {
+        switch(option)
+        {
+            case 'n':
+                options.conversations = atoi(optarg);
+                break;
+            case 't':
+                options.threads = std::max(atoi(optarg), 1);
+                break;
+            case 'c':
+                options.window = std::max(atoi(optarg), 1);
+                break;
+            case 'i':
+                options.invalidPercent = atoi(optarg);
+                break;
+            case 's':
+                options.seed = atoi(optarg);
+                break;
+            case 'p':
+                options.protocolDir = optarg;
+                break;
+            case 'r':
+                options.replayFile = optarg;
+                break;
+            case 'w':
+                options.recordFile = optarg;
+                break;
+            case 'h':
+            default:
+                usage(argv[0]);
+                exit(0);
+        }
+    }
+
+    std::vector<load::Scenario> scenarios;
+    bool checkValidity = true;
+    try {
+        // Load the protocols before the measurement starts
+        StateMachineFactory::setProtocolResourceDir(options.protocolDir);
+        StateMachineFactory::getStateMachine("request");
+
+        if(!options.replayFile.empty())
+        {
+            double decodingTime;
+            scenarios = load::replay(options, decodingTime);
+            checkValidity = false;
+            printf("replayed conversations: %lu\n", scenarios.size());
+            printf("decoding time: %.3f ms\n", decodingTime/1.0E3);
+        } else {
+            scenarios = load::createScenarios(options);
+            if(!options.recordFile.empty())
+            {
+                load::record(scenarios, options);
+                printf("recorded conversations: %lu to '%s'\n", scenarios.size(), options.recordFile.c_str());
+                return 0;
+            }
+        }
+    } catch(const std::exception& e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    // Messages of a conversation are always handled by the same thread to keep them in order
+    std::vector< std::vector<const load::Scenario*> > assignments(options.threads);
+    boost::hash<std::string> hash;
+    for(size_t i = 0; i < scenarios.size(); ++i)
+    {
+        if(scenarios[i].messages.empty())
+        {
+            continue;
+        }
+        size_t thread = hash(scenarios[i].messages.front().getConversationID()) % options.threads;
+        assignments[thread].push_back(&scenarios[i]);
+    }
+
+    ConversationMonitor monitor(AgentID("load-generator"));
+    std::vector<load::Statistics> statistics(options.threads);
+
+    double start = load::now();
+    boost::thread_group threads;
+    for(size_t i = 0; i < options.threads; ++i)
+    {
+        threads.create_thread(boost::bind(&load::drive, &monitor, &assignments[i], options.window, &statistics[i]));
+    }
+    threads.join_all();
+    double duration = load::now() - start;
+
+    load::Statistics total;
+    for(size_t i = 0; i < statistics.size(); ++i)
+    {
+        total.latencies.insert(total.latencies.end(), statistics[i].latencies.begin(), statistics[i].latencies.end());
+        total.accepted += statistics[i].accepted;
+        total.rejected += statistics[i].rejected;
+        total.unexpected += statistics[i].unexpected;
+    }
+    std::sort(total.latencies.begin(), total.latencies.end());
+
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    size_t updates = total.latencies.size();
+    printf("threads: %lu\n", options.threads);
+    printf("conversations: %lu\n", scenarios.size());
+    printf("updates: %lu (accepted: %lu, rejected: %lu)\n", updates, total.accepted, total.rejected);
+    if(checkValidity)
+    {
+        printf("unexpected results: %lu\n", total.unexpected);
+    }
+    printf("duration: %.3f ms\n", duration/1.0E3);
+    printf("updates/sec: %.1f\n", duration > 0 ? updates/(duration/1.0E6) : 0.0);
+    printf("latency p50: %.3f us\n", load::percentile(total.latencies, 0.5));
+    printf("latency p99: %.3f us\n", load::percentile(total.latencies, 0.99));
+    printf("latency max: %.3f us\n", total.latencies.empty() ? 0.0 : total.latencies.back());
+    printf("peak rss: %ld kB\n", usage.ru_maxrss);
+
+    return checkValidity && total.unexpected ? 2 : 0;
+}
@@ -12,17 +12,30 @@ const RoleId Role::SELF_ID ="__self__";
 
 Role::Role()
     : mId(Role::UNDEFINED_ID)
+    , mIsPattern(false)
 {
 }
 
 Role::Role(const RoleId& id)
     : mId(id)
+    , mIsPattern(Role::isPattern(id))
 {
+    if(mIsPattern)
+    {
+        mRegex = boost::regex(id);
+    }
 }
 
 Role::Role(const Role& other)
+    : mId(other.mId)
+    , mIsPattern(other.mIsPattern)
+    , mRegex(other.mRegex)
+{
+}
+
+bool Role::isPattern(const std::string& name)
 {
-    mId = other.mId;
+    return name.find_first_of(".[]{}()\\*+?|^$") != std::string::npos;
 }
 
 UndefinedRole::UndefinedRole()
@@ -47,7 +60,7 @@ void RoleMapping::setSelf(const AgentID& id)
 
     if(it->second.front() == UndefinedAgentID())
     {
-        it->second.clear();
+        clearExpectedAgents(SelfRole());
         addExpectedAgent(SelfRole(), id);
     } else {
         std::string msg = "Self is already set";
@@ -95,6 +108,13 @@ void RoleMapping::addExpectedAgent(const Role& role, const AgentID& agent)
     if(eit == expectedAgents.end())
     {
         expectedAgents.push_back(agent);
+
+        const std::string& name = agent.getName();
+        mAgentRoleBindings[name].insert(role.getId());
+        if(Role::isPattern(name))
+        {
+            mRolePatterns[role.getId()].push_back(boost::regex(name));
+        }
     }
 
     return;
@@ -105,13 +125,29 @@ void RoleMapping::clearExpectedAgents(const Role& role)
     std::map<Role, AgentIDList>::iterator it = mExpectedAgentMapping.find(role);
     if(it != mExpectedAgentMapping.end())
     {
+        AgentIDList::const_iterator ait = it->second.begin();
+        for(; ait != it->second.end(); ++ait)
+        {
+            AgentRoleBindings::iterator bit = mAgentRoleBindings.find(ait->getName());
+            if(bit != mAgentRoleBindings.end())
+            {
+                bit->second.erase(role.getId());
+                if(bit->second.empty())
+                {
+                    mAgentRoleBindings.erase(bit);
+                }
+            }
+        }
         it->second.clear();
+        mRolePatterns.erase(role.getId());
     }
 }
 
 void RoleMapping::resetExpectedAgents()
 {
     mExpectedAgentMapping.clear();
+    mAgentRoleBindings.clear();
+    mRolePatterns.clear();
 
     addRole(SelfRole());
     addExpectedAgent(SelfRole(), UndefinedAgentID());
@@ -121,45 +157,78 @@ bool RoleMapping::isExpected(const Role& role, const AgentID& agent) const
 {
     // Check first if role regex matches agent name
     // afterwards try to resolve roles
-    boost::regex roleRegex(role.getId());
-    if(regex_match(agent.getName(), roleRegex))
+    if(role.matches(agent.getName()))
     {
         return true;
     }
 
-    const AgentIDList& expectedAgents = getExpectedAgents(role);
+    std::map<Role, AgentIDList>::const_iterator it = mExpectedAgentMapping.find(role);
+    if(it == mExpectedAgentMapping.end())
+    {
+        LOG_DEBUG_S << "Unexpected role '" << role.toString() << "'.";
+        return false;
+    }
+    const AgentIDList& expectedAgents = it->second;
 
-    bool expected = false;
     // Indication of an unassigned role -- this should be valid
     if(expectedAgents.empty())
     {
         return true;
     }
 
-    // Agent has to match against one in the list
-    AgentIDList::const_iterator eit = expectedAgents.begin(); 
-    for(; eit != expectedAgents.end(); ++eit)
+    // Agent has to match against one in the list: exact names first,
+    // then the names that are patterns
+    if(isBound(role, agent))
     {
-        boost::regex regex(eit->getName() + "$");
-        if(regex_match(agent.getName(), regex))
+        return true;
+    }
+
+    RolePatterns::const_iterator pit = mRolePatterns.find(role.getId());
+    if(pit != mRolePatterns.end())
+    {
+        std::vector<boost::regex>::const_iterator rit = pit->second.begin();
+        for(; rit != pit->second.end(); ++rit)
         {
-            expected = true;
+            if(boost::regex_match(agent.getName(), *rit))
+            {
+                return true;
+            }
         }
     }
 
-    return expected;
+    return false;
 }
 
-const AgentIDList& RoleMapping::getExpectedAgents(const Role& role) const
+bool RoleMapping::isBound(const Role& role, const AgentID& agent) const
+{
+    AgentRoleBindings::const_iterator bit = mAgentRoleBindings.find(agent.getName());
+    if(bit == mAgentRoleBindings.end())
+    {
+        return false;
+    }
+    return bit->second.count(role.getId()) != 0;
+}
+
+const AgentIDList* RoleMapping::findExpectedAgents(const Role& role) const
 {
     std::map<Role, AgentIDList>::const_iterator it = mExpectedAgentMapping.find(role);
     if(it == mExpectedAgentMapping.end())
+    {
+        return NULL;
+    }
+    return &it->second;
+}
+
+const AgentIDList& RoleMapping::getExpectedAgents(const Role& role) const
+{
+    const AgentIDList* expectedAgents = findExpectedAgents(role);
+    if(!expectedAgents)
     {
         std::string msg = "Unexpected role '" + role.toString() + "'.";
         LOG_ERROR("%s", msg.c_str());
         throw std::runtime_error(msg);
     }
-    return it->second;
+    return *expectedAgents;
 }
 
 std::string RoleMapping::toString() const
@@ -2,7 +2,11 @@
 #define FIPA_ACL_ROLE_H
 
 #include <map>
+#include <set>
 #include <string>
+#include <vector>
+#include <boost/regex.hpp>
+#include <boost/unordered_map.hpp>
 #include <fipa_acl/message_generator/agent_id.h>
 
 namespace fipa {
@@ -18,6 +22,12 @@ class Role
 private:
     RoleId mId;
 
+    // Whether the role id contains regular expression syntax
+    bool mIsPattern;
+
+    // Role id compiled as regular expression to match agent names (only if it is a pattern)
+    boost::regex mRegex;
+
 protected:
     /**
      * Interal role ids
@@ -51,6 +61,25 @@ public:
      */
     RoleId getId() const { return mId; }
 
+    /**
+     * Test whether the agent name matches the role id (as regular expression)
+     * Role ids without regular expression syntax are compared directly
+     */
+    bool matches(const std::string& agentName) const
+    {
+        return mIsPattern ? boost::regex_match(agentName, mRegex) : agentName == mId;
+    }
+
+    /**
+     * Test whether the role id has to be interpreted as regular expression
+     */
+    bool isPattern() const { return mIsPattern; }
+
+    /**
+     * Test whether a name contains regular expression syntax
+     */
+    static bool isPattern(const std::string& name);
+
     /**
      * Convert role to a string
      * \return string
@@ -75,6 +104,8 @@ public:
     Role& operator=(const Role& other)
     {
         mId = other.mId;
+        mIsPattern = other.mIsPattern;
+        mRegex = other.mRegex;
         return *this;
     }
 };
@@ -94,6 +125,11 @@ public:
 /**
  * \class RoleMapping
  * \brief Mapping between roles and actual agent ids 
+ *
+ * Besides the list of expected agents per role, the bindings of agent names to roles
+ * are kept in a hash map, so that the common case of an exactly named agent is resolved
+ * without regular expression matching. Only expected agent names that contain
+ * regular expression syntax are matched as patterns
  */
 class RoleMapping
 {
@@ -101,6 +137,14 @@ private:
     // The mapping between roles and actual agents
     std::map<Role, AgentIDList> mExpectedAgentMapping;
 
+    typedef boost::unordered_map<std::string, std::set<RoleId> > AgentRoleBindings;
+    // Agent name to the roles it has been bound to
+    AgentRoleBindings mAgentRoleBindings;
+
+    typedef std::map<RoleId, std::vector<boost::regex> > RolePatterns;
+    // Compiled expected agent names that are patterns, per role
+    RolePatterns mRolePatterns;
+
 public:
 
     /**
@@ -156,9 +200,21 @@ public:
      */
     const AgentIDList& getExpectedAgents(const Role& role) const;
 
+    /**
+     * Get the list of expected agents for a given role
+     * \return pointer to the list, or NULL if the role does not exist
+     */
+    const AgentIDList* findExpectedAgents(const Role& role) const;
+
+    /**
+     * Check whether the agent has been added as expected agent of the given role
+     * (exact match of the agent name)
+     */
+    bool isBound(const Role& role, const AgentID& agent) const;
+
     /**
      * Check whether the given agent belongs to the list of expected receivers
-     * \throws If role is completely unknown to this role mapping
+     * \return true if agent is expected, false otherwise or if the role is unknown to this role mapping
      */
     bool isExpected(const Role& role, const AgentID& agent) const;
 
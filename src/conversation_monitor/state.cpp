@@ -4,6 +4,7 @@
 #include "message_archive.h"
 #include "statemachine.h"
 
+#include <algorithm>
 #include <boost/assign/list_of.hpp>
 #include <boost/regex.hpp>
 #include <iostream>
@@ -30,15 +31,47 @@ std::vector<StateId> State::msDefaultStates = boost::assign::list_of
     (State::GENERAL_FAILURE_STATE)
     ;
 
+/**
+ * Create the mapping from performative to the index in the dispatch table
+ */
+static std::map<std::string, size_t> createPerformativeIndices()
+{
+    std::map<std::string, size_t> indices;
+    for(size_t i = 0; i < (size_t) ACLMessage::END_PERFORMATIVE; ++i)
+    {
+        indices[PerformativeTxt[(ACLMessage::Performative) i]] = i;
+    }
+    return indices;
+}
+
+/**
+ * Get the index in the dispatch table for a performative
+ * \return index of the predefined performative, or ACLMessage::END_PERFORMATIVE for custom performatives
+ */
+static size_t getPerformativeIndex(const std::string& performative)
+{
+    static const std::map<std::string, size_t> indices = createPerformativeIndices();
+    std::map<std::string, size_t>::const_iterator it = indices.find(performative);
+    if(it == indices.end())
+    {
+        return ACLMessage::END_PERFORMATIVE;
+    }
+    return it->second;
+}
+
 State::State() 
     : mId(State::UNDEFINED_ID)
     , mIsFinal(false)
+    , mNumberOfFinishedSubStateMachines(0)
+    , mTransitionsByPerformative(ACLMessage::END_PERFORMATIVE + 1)
 {
 }
 
 State::State(const StateId& uid) 
     : mId(uid)
     , mIsFinal(false)
+    , mNumberOfFinishedSubStateMachines(0)
+    , mTransitionsByPerformative(ACLMessage::END_PERFORMATIVE + 1)
 {
 }
 
@@ -51,6 +84,17 @@ Transition State::addTransition(const Transition& t)
         Transition transition = t;
         transition.setSourceState(mId);
         mTransitions.push_back(transition);
+
+        // Update dispatch table
+        size_t index = mTransitions.size() - 1;
+        for(size_t i = 0; i < (size_t) ACLMessage::END_PERFORMATIVE; ++i)
+        {
+            if(transition.matchesPerformative(PerformativeTxt[(ACLMessage::Performative) i]))
+            {
+                mTransitionsByPerformative[i].push_back(index);
+            }
+        }
+        mTransitionsByPerformative[ACLMessage::END_PERFORMATIVE].push_back(index);
         return transition;
     } else {
         return *it;
@@ -78,8 +122,7 @@ void State::generateDefaultTransitions()
     for (; it != transitions.end();++it)
     {
         // we don't generate a not-understood transition for not-understood message...
-        boost::regex peformativeRegex(it->getPerformativeRegExp());
-        if(regex_match(PerformativeTxt[ACLMessage::NOT_UNDERSTOOD], peformativeRegex))
+        if(it->matchesPerformative(PerformativeTxt[ACLMessage::NOT_UNDERSTOOD]))
         {
             continue;
         } else {
@@ -91,7 +134,7 @@ void State::generateDefaultTransitions()
             addTransition(*dynamic_cast<Transition*>(&transitionReceiver));
         }
 
-        if(regex_match(PerformativeTxt[ACLMessage::CANCEL], peformativeRegex))
+        if(it->matchesPerformative(PerformativeTxt[ACLMessage::CANCEL]))
         {
             continue;
         } else {
@@ -103,7 +146,7 @@ void State::generateDefaultTransitions()
             addTransition(*dynamic_cast<Transition*>(&transitionReceiver));
         }
 
-        if(regex_match(PerformativeTxt[ACLMessage::FAILURE], peformativeRegex))
+        if(it->matchesPerformative(PerformativeTxt[ACLMessage::FAILURE]))
         {
             continue;
         } else {
@@ -149,28 +192,17 @@ void State::consumeSubStateMachineMessage(const ACLMessage& msg, const fipa::acl
     LOG_INFO("State consumeSubStateMachineMessage");
     
     // Loop through all not-ended sub state machines
-    for(std::vector<StateMachine>::iterator it0 = mSubStateMachines.begin(); it0 != mSubStateMachines.end(); it0++)
+    for(std::list<StateMachine>::iterator it0 = mSubStateMachines.begin(); it0 != mSubStateMachines.end(); it0++)
     {
-        if(it0->inFinalState() || it0->inFailureState())
+        // Test the update -- the state machine remains unchanged if the message does not apply
+        LOG_DEBUG("Trying an existing sub state machine");
+        if(it0->tryConsumeMessage(msg))
         {
-            // StateMachine ended already
-            continue;
-        }
-        // Test if this StateMachine is correct by maintaining a copy of it
-        StateMachine copy = *it0;
-        
-        // Test the update
-        try {
-            LOG_DEBUG("Trying an existing sub state machine");
-            it0->consumeMessage(msg);
             // It worked
+            collapseIfFinished(it0);
             return;
-        } catch(const std::runtime_error& e)
-        {
-            LOG_DEBUG("Sub state machine incorrect: ", e.what());
-            // The state machine was obviously not correct, we play back the copy
-            *it0 = copy;
         }
+        LOG_DEBUG("Sub state machine incorrect");
     }
     
     LOG_DEBUG("Trying to search for a fitting a embedded state machine");
@@ -187,18 +219,15 @@ void State::consumeSubStateMachineMessage(const ACLMessage& msg, const fipa::acl
         boost::regex peformativeRegex(it->name);
         if(regex_match(protocol, peformativeRegex))
         {           
-            // Check that the sender role is correct
-            // This throws if the mapping does not exist
-            const AgentIDList l = roleMapping.getMapping().at(it->fromRole);
-            AgentIDList::const_iterator lit = std::find(l.begin(), l.end(), msg.getSender());
-            if(lit == l.end())
+            // Check that the sender role is correct, i.e. the role has
+            // been mapped and the sender is bound to it
+            if(!roleMapping.isBound(it->fromRole, msg.getSender()))
             {
-                // Sender does not match
                 continue;
             }
             
             // Check that the number of subconversations allows another one
-            if(mSubStateMachines.size() >= numberOfSubConversations)
+            if(getNumberOfSubStateMachines() >= numberOfSubConversations)
             {
                 continue;
             }
@@ -226,20 +255,17 @@ void State::consumeSubStateMachineMessage(const ACLMessage& msg, const fipa::acl
         subStateMachine.setSelf(msg.getSender());
         
         // update the message state machine
-        try {
-            LOG_DEBUG("Substate machine initialized, trying to consume message");
-            subStateMachine.consumeMessage(msg);
-        } catch(const std::runtime_error& e)
+        LOG_DEBUG("Substate machine initialized, trying to consume message");
+        if(!subStateMachine.tryConsumeMessage(msg))
         {
             // Also constructing and using a new one did not work for that message.
-            std::string errorMsg = "Substatemachine creation failed: ";
-            errorMsg += " -- " + std::string(e.what());
-            throw std::runtime_error(errorMsg);
+            throw std::runtime_error("Substatemachine creation failed:  -- Message does not trigger any (incl. proxied) transitions in this state");
         }
         
         // If that was successful, save the actual protocol and number of subconversations in the embedded state machine
         LOG_DEBUG("New sub state machine consumed message");
         mSubStateMachines.push_back(subStateMachine);
+        collapseIfFinished(--mSubStateMachines.end());
         embeddedStateMachinePtr->actualProtocol = protocol;
         embeddedStateMachinePtr->numberOfSubConversations = numberOfSubConversations;
     } else {
@@ -250,34 +276,70 @@ void State::consumeSubStateMachineMessage(const ACLMessage& msg, const fipa::acl
     LOG_DEBUG("State consumeSubStateMachineMessage successfully created new sub state machine");
 }
 
+std::list<StateMachine>::iterator State::collapseIfFinished(std::list<StateMachine>::iterator it)
+{
+    if(it->inFinalState() || it->inFailureState())
+    {
+        // Only the outcome of a finished sub state machine is kept
+        ++mSubStateMachineOutcomes[it->getCurrentStateId()];
+        ++mNumberOfFinishedSubStateMachines;
+        return mSubStateMachines.erase(it);
+    }
+    return ++it;
+}
+
 const Transition& State::getTransition(const ACLMessage &msg, const MessageArchive& archive, const RoleMapping& roleMapping) const
 {
-    std::vector<Transition>::const_iterator it = mTransitions.begin();
-    for (; it != mTransitions.end(); ++it)
+    const Transition* transition = findTransition(msg, archive, roleMapping);
+    if(!transition)
     {
+        throw std::runtime_error("Message does not trigger any transition in this state");
+    }
+    return *transition;
+}
+
+const Transition* State::findTransition(const ACLMessage &msg, const MessageArchive& archive, const RoleMapping& roleMapping) const
+{
+    // Only transitions whose performative expression matches are candidates
+    size_t performativeIndex = getPerformativeIndex(msg.getPerformative());
+    const std::vector<size_t>& candidates = mTransitionsByPerformative[performativeIndex];
+
+    std::vector<size_t>::const_iterator it = candidates.begin();
+    for (; it != candidates.end(); ++it)
+    {
+        const Transition& transition = mTransitions[*it];
         // TODO: better use the directly corresponding one
         // but this should be ok for now
         if(!archive.hasMessages())
         {
             // Initiating message, i.e. validation should only apply to performative
-            boost::regex peformativeRegex(it->getPerformativeRegExp());
-            if(regex_match(msg.getPerformative(), peformativeRegex))
+            if(performativeIndex != ACLMessage::END_PERFORMATIVE || transition.matchesPerformative(msg.getPerformative()))
             {
-                return *it;
+                return &transition;
             }
         } else {
             const ACLMessage& initiatingMsg = archive.getInitiatingMessage();
-            if (it->triggers(msg, initiatingMsg, roleMapping)) 
+            if (transition.triggers(msg, initiatingMsg, roleMapping)) 
             {
-                return *it;
+                return &transition;
             }
         }
     }
 
-    throw std::runtime_error("Message does not trigger any transition in this state");
+    return NULL;
 }
 
 const Transition& State::getSubstateMachineProxiedTransition(const ACLMessage& msg, const MessageArchive& archive, const RoleMapping& roleMapping)
+{
+    const Transition* transition = findSubstateMachineProxiedTransition(msg, archive, roleMapping);
+    if(!transition)
+    {
+        throw std::runtime_error("Message does not trigger any (incl. proxied) transitions in this state");
+    }
+    return *transition;
+}
+
+const Transition* State::findSubstateMachineProxiedTransition(const ACLMessage& msg, const MessageArchive& archive, const RoleMapping& roleMapping)
 {
     if(archive.hasMessages())
     {
@@ -299,16 +361,22 @@ const Transition& State::getSubstateMachineProxiedTransition(const ACLMessage& m
                 {
                     // Save that a proxied reply was received
                     it0->receivedProxiedReply = true;
-                    mSubstateMachineProxiedTransitions.push_back(transition);
                     LOG_DEBUG("Transition triggered");
-                    // We cannot use the local var to return as a reference
-                    return mSubstateMachineProxiedTransitions.back();
+                    // We cannot use the local var to return as a reference, but
+                    // reuse an identical transition that has been generated before
+                    std::vector<Transition>::const_iterator tit = std::find(mSubstateMachineProxiedTransitions.begin(), mSubstateMachineProxiedTransitions.end(), transition);
+                    if(tit != mSubstateMachineProxiedTransitions.end())
+                    {
+                        return &(*tit);
+                    }
+                    mSubstateMachineProxiedTransitions.push_back(transition);
+                    return &mSubstateMachineProxiedTransitions.back();
                 }
             }
         }
     }
 
-    throw std::runtime_error("Message does not trigger any (incl. proxied) transitions in this state");
+    return NULL;
 }
 
 bool State::isFinished() const
@@ -318,16 +386,12 @@ bool State::isFinished() const
         return false;
     }
     
-    // Check all subprotocols
-    std::vector<StateMachine>::const_iterator it;
-    for(it = mSubStateMachines.begin(); it != mSubStateMachines.end(); it++)
+    // Check all subprotocols -- finished ones have been collapsed into outcomes
+    if(!mSubStateMachines.empty())
     {
-        if(!it->inFinalState() && !it->inFailureState())
-        {
-            LOG_DEBUG("State not finished (subconversation still running)");
-            return false;
-        }
-    } 
+        LOG_DEBUG("State not finished (subconversation still running)");
+        return false;
+    }
     
     // When there are embedded state machines, they all must have forwarded a proxied reply, if this was
     // necessary in the first place
@@ -336,7 +400,7 @@ bool State::isFinished() const
     {
         // They must also all have started enough sub state machines
         // Check that enough subprotocols have been started
-        if(it0->numberOfSubConversations != mSubStateMachines.size())
+        if(it0->numberOfSubConversations != getNumberOfSubStateMachines())
         {
             LOG_DEBUG("State not finished (subconversation still running)");
             return false;
@@ -8,6 +8,7 @@
 #ifndef _FIPAACL_CONVMONITOR_STATE_H_
 #define _FIPAACL_CONVMONITOR_STATE_H_
 
+#include <list>
 #include <map>
 #include <vector>
 
@@ -65,6 +66,13 @@ private:
     */
     std::vector<Transition> mTransitions;
 
+    /**
+    * Dispatch table for the outgoing transitions: for each predefined performative the indices of
+    * the transitions (in order) whose performative expression matches, the last entry
+    * lists all transitions and is used for custom performatives
+    */
+    std::vector< std::vector<size_t> > mTransitionsByPerformative;
+
     /** 
     * Embedded statemachines implement the subprotocol concept from the fipa speciffication as a state machine.
     * Each embedded state machine belongs to the state from which the subprotocol starts;
@@ -74,17 +82,34 @@ private:
     std::vector<EmbeddedStateMachine> mEmbeddedStateMachines;
     
     /**
-    * The subprotocol statemachines. These are actually running.
+    * The subprotocol statemachines. These are actually running, i.e.
+    * finished ones are removed and accounted for in mSubStateMachineOutcomes
+    */
+    std::list<fipa::acl::StateMachine> mSubStateMachines;
+
+    /**
+    * Number of finished subprotocol statemachines per final state
     */
-    std::vector<fipa::acl::StateMachine> mSubStateMachines;
+    std::map<StateId, size_t> mSubStateMachineOutcomes;
+
+    /**
+    * Number of finished subprotocol statemachines
+    */
+    size_t mNumberOfFinishedSubStateMachines;
     
     /**
     * List of outgoing transitions that belong to this state, proxied by a substatemachine.
     * These are just maintained here in order to produce no memory leaks, and only constructed
-    * on-the-fly.
+    * on-the-fly. Each distinct transition is stored only once.
     */
     std::vector<Transition> mSubstateMachineProxiedTransitions;
 
+    /**
+    * Move the subprotocol statemachine to the outcomes if it is finished
+    * \return iterator to the next subprotocol statemachine
+    */
+    std::list<fipa::acl::StateMachine>::iterator collapseIfFinished(std::list<fipa::acl::StateMachine>::iterator it);
+
     static std::vector<StateId> msDefaultStates;
 
 protected:
@@ -130,6 +155,12 @@ public:
     *  \throws runtime_error if the msg is invalid in the current state
     */
     const Transition& getTransition(const ACLMessage &msg, const MessageArchive& archive, const RoleMapping& roleMapping) const;
+
+    /**
+    *  \brief Find the transition which is triggered by the received message
+    *  \return the transition, or NULL if the msg is invalid in the current state
+    */
+    const Transition* findTransition(const ACLMessage &msg, const MessageArchive& archive, const RoleMapping& roleMapping) const;
     
     /**
      * Tries to consume a message meant for a sub state machine.
@@ -145,6 +176,13 @@ public:
     */
     const Transition& getSubstateMachineProxiedTransition(const ACLMessage &msg, const MessageArchive& archive, const RoleMapping& roleMapping);
 
+    /**
+    *  \brief Find the substatemachine proxied transition which is triggered by the received message
+    *  \see getSubstateMachineProxiedTransition
+    *  \return the transition, or NULL if the msg is invalid in the current state
+    */
+    const Transition* findSubstateMachineProxiedTransition(const ACLMessage &msg, const MessageArchive& archive, const RoleMapping& roleMapping);
+
     /**
     *  \brief method that generates implicit generic transitions applicable to all states, that may or may not be speciffied in the 
     *  configuration file such as not-understood transition (if it is specified it is not doubled);
@@ -162,6 +200,18 @@ public:
     */
     bool isFinished() const;
 
+    /**
+     * Get the number of subprotocol statemachines which have been started in this state
+     * \return number of running and finished subprotocol statemachines
+     */
+    size_t getNumberOfSubStateMachines() const { return mSubStateMachines.size() + mNumberOfFinishedSubStateMachines; }
+
+    /**
+     * Get the outcomes of the finished subprotocol statemachines
+     * \return map of final state to the number of subprotocol statemachines that ended in this state
+     */
+    const std::map<StateId, size_t>& getSubStateMachineOutcomes() const { return mSubStateMachineOutcomes; }
+
     /**
      * \brief Test if state belongs to the default state or not
      * \return true if state is default, false otherwise
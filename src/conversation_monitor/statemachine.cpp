@@ -186,30 +186,35 @@ void StateMachine::consumeSubStateMachineMessage(const ACLMessage& msg, const St
 
 void StateMachine::consumeMessage(const ACLMessage& msg)
 {
-    LOG_DEBUG("StateMachine consumeMessage");
-    
-    try
+    if(!tryConsumeMessage(msg))
     {
-        const State& currentState = getCurrentState();
-        const Transition& transition = currentState.getTransition(msg, mMessageArchive, mRoleMapping);
-        updateRoleMapping(msg, transition);
-        mMessageArchive.addMessage(msg);
-
-        // Perform transition
-        mCurrentStateId = transition.getTargetStateId();
+        throw std::runtime_error("Message does not trigger any (incl. proxied) transitions in this state");
     }
-    catch(const std::exception& e)
+}
+
+bool StateMachine::tryConsumeMessage(const ACLMessage& msg)
+{
+    LOG_DEBUG("StateMachine consumeMessage");
+    
+    State& currentState = getCurrentStateModifiably();
+    const Transition* transition = currentState.findTransition(msg, mMessageArchive, mRoleMapping);
+    if(!transition)
     {
         LOG_DEBUG("StateMachine consumeMessage trying substatemachine proxied transition");
         // Retry with substatemachineproxied transition
-        State& currentState = getCurrentStateModifiably();
-        const Transition& transition = currentState.getSubstateMachineProxiedTransition(msg, mMessageArchive, mRoleMapping);
-        updateRoleMapping(msg, transition);
-        mMessageArchive.addMessage(msg);
-
-        // Perform transition
-        mCurrentStateId = transition.getTargetStateId();
+        transition = currentState.findSubstateMachineProxiedTransition(msg, mMessageArchive, mRoleMapping);
+        if(!transition)
+        {
+            return false;
+        }
     }
+
+    updateRoleMapping(msg, *transition);
+    mMessageArchive.addMessage(msg);
+
+    // Perform transition
+    mCurrentStateId = transition->getTargetStateId();
+    return true;
 }
 
 bool StateMachine::inFinalState() const
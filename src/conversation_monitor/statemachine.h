@@ -157,6 +157,16 @@ public:
      * \throws std::runtime_error if message could not be consumed
      */
     void consumeMessage(const ACLMessage& msg);
+
+    /**
+     * Try to consume a message
+     * If this is the first message it will initialize the roles for the first state
+     * \param msg Message which should be consumed
+     * \return true if message has been consumed, false if it does not trigger any transition in the current state
+     * (the state machine remains unchanged then)
+     * \throws std::runtime_error if statemachine has not been properly initialized, or if the message has no receivers
+     */
+    bool tryConsumeMessage(const ACLMessage& msg);
     
     /**
      * Consume a message meant for sub state machine.
@@ -230,6 +240,7 @@ struct EmbeddedStateMachine
 
     EmbeddedStateMachine()
         : numberOfSubConversations(-1)
+        , receivedProxiedReply(false)
     {}
     
     /**
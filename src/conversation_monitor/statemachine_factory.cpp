@@ -1,5 +1,9 @@
 #include "statemachine_factory.h"
+#include <algorithm>
 #include <boost/filesystem/operations.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <sys/stat.h>
 #include <base/logging.h>
 #include "statemachine_reader.h"
 #include "transition.h"
@@ -9,19 +13,69 @@ namespace fs = boost::filesystem;
 namespace fipa {
 namespace acl {
 
-bool StateMachineFactory::msPreparedResourceDir = false;
+// Upper bound for the threads loading specifications, since the files are small
+// more threads do not pay off
+static const size_t MAX_LOADER_THREADS = 4;
+
+/**
+ * Load specifications by index, shared between the threads of the loader pool
+ */
+template<typename Specification>
+struct SpecificationLoader
+{
+    std::vector<Specification*>* specifications;
+    // char instead of bool, so that the threads can write different elements concurrently
+    std::vector<char>* loaded;
+    boost::atomic<size_t>* next;
+
+    void operator()()
+    {
+        StateMachineReader reader;
+        size_t index;
+        while( (index = (*next)++) < specifications->size())
+        {
+            Specification& specification = *(*specifications)[index];
+            try {
+                specification.statemachine = reader.loadSpecification(specification.file);
+                (*loaded)[index] = 1;
+            } catch(const std::runtime_error& e)
+            {
+                LOG_ERROR("Error loading specification for: '%s' - %s", fs::path(specification.file).filename().string().c_str(), e.what());
+            }
+        }
+    }
+};
+
+boost::mutex StateMachineFactory::msMutex;
+boost::atomic<bool> StateMachineFactory::msPreparedResourceDir(false);
 std::vector<std::string> StateMachineFactory::msResourceDirs;
-std::map<std::string, StateMachine> StateMachineFactory::msStateMachines;
+StateMachineFactory::StateMachineMapPtr StateMachineFactory::msStateMachines(new StateMachineFactory::StateMachineMap());
+std::map<std::string, StateMachineFactory::Specification> StateMachineFactory::msSpecifications;
+boost::shared_ptr<boost::thread> StateMachineFactory::msWatcher;
+boost::mutex StateMachineFactory::msWatcherMutex;
 
-StateMachineReader StateMachineFactory::msStateMachineReader;
+bool StateMachineFactory::Specification::hasStatus(const Specification& other) const
+{
+    return modificationTime == other.modificationTime
+        && modificationTimeNsec == other.modificationTimeNsec
+        && size == other.size
+        && inode == other.inode;
+}
 
 void StateMachineFactory::setProtocolResourceDir(const std::string& resourceDir)
 {
+    boost::unique_lock<boost::mutex> lock(msMutex);
     msResourceDirs.clear();
-    addProtocolResourceDir(resourceDir);
+    registerProtocolResourceDir(resourceDir);
 }
 
 void StateMachineFactory::addProtocolResourceDir(const std::string& resourceDir)
+{
+    boost::unique_lock<boost::mutex> lock(msMutex);
+    registerProtocolResourceDir(resourceDir);
+}
+
+void StateMachineFactory::registerProtocolResourceDir(const std::string& resourceDir)
 {
     fs::path protocolDir = fs::path(resourceDir);
     if(fs::is_directory(protocolDir))
@@ -41,65 +95,159 @@ void StateMachineFactory::addProtocolResourceDir(const std::string& resourceDir)
     }
 }
 
-void StateMachineFactory::prepareProtocolsFromResourceDirs()
+void StateMachineFactory::listSpecifications(const std::string& resourceDir, std::vector<Specification>& specifications)
 {
-    std::vector<std::string>::const_iterator it = msResourceDirs.begin();
-    for(; it != msResourceDirs.end(); ++it)
+    fs::path protocolDir = fs::path(resourceDir);
+    LOG_DEBUG("Prepare protocols from: '%s'", protocolDir.string().c_str());
+    if(fs::is_directory(protocolDir))
     {
-        prepareProtocolsFromResourceDir(*it);
+        std::vector<std::string> files;
+        fs::directory_iterator it(protocolDir);
+        for(; it != fs::directory_iterator(); ++it)
+        {
+            if(fs::is_regular_file(it->status()))
+            {
+                files.push_back(it->path().string());
+            }
+        }
+        // Sort for a deterministic order of registration
+        std::sort(files.begin(), files.end());
+
+        std::vector<std::string>::const_iterator fit = files.begin();
+        for(; fit != files.end(); ++fit)
+        {
+            struct stat status;
+            if(stat(fit->c_str(), &status) != 0)
+            {
+                continue;
+            }
+
+            Specification specification;
+            specification.file = *fit;
+            specification.modificationTime = status.st_mtim.tv_sec;
+            specification.modificationTimeNsec = status.st_mtim.tv_nsec;
+            specification.size = status.st_size;
+            specification.inode = status.st_ino;
+            specification.loaded = false;
+            specifications.push_back(specification);
+        }
     }
 }
 
-void StateMachineFactory::prepareProtocolsFromResourceDir(const std::string& resourceDir)
+bool StateMachineFactory::prepareProtocolsFromResourceDirs()
 {
-    fs::path protocolDir = fs::path(resourceDir);
-    LOG_INFO("Prepare protocols from: '%s'", protocolDir.string().c_str());
-    if(fs::is_directory(protocolDir))
+    std::vector<Specification> specifications;
+    std::vector<std::string>::const_iterator it = msResourceDirs.begin();
+    for(; it != msResourceDirs.end(); ++it)
     {
-        std::vector<fs::path> files;
-        std::copy(fs::directory_iterator(protocolDir), fs::directory_iterator(), std::back_inserter(files));
+        listSpecifications(*it, specifications);
+    }
 
-        std::vector<fs::path>::iterator it = files.begin();
-        for(;it != files.end(); ++it)
+    // Take unchanged specifications from the previous run, compile the others
+    std::vector<Specification*> pending;
+    size_t unchanged = 0;
+    std::vector<Specification>::iterator sit = specifications.begin();
+    for(; sit != specifications.end(); ++sit)
+    {
+        std::map<std::string, Specification>::const_iterator cached = msSpecifications.find(sit->file);
+        if(cached != msSpecifications.end() && cached->second.hasStatus(*sit))
         {
-            if(fs::is_regular_file(*it))
-            {
-                // Extract protocol name
-                std::string protocolName = it->string();
-                size_t pos = protocolName.find_last_of("/");
-                protocolName.erase(0, pos+1);
-
-                try {
-                    // Loading the state machine from the given spec
-                    StateMachine statemachine = msStateMachineReader.loadSpecification(it->string()); 
-                    LOG_INFO("Register protocol %s", protocolName.c_str());
-                    std::map<std::string, StateMachine>::const_iterator statemachinesIt = msStateMachines.find(protocolName);
-                    if( statemachinesIt != msStateMachines.end())
-                    {
-                        LOG_WARN("Protocol '%s' already registered - will use statemachine specification from '%s'", protocolName.c_str(), it->string().c_str());
-                    }
-                    msStateMachines[protocolName] = statemachine;
-                } catch(const std::runtime_error& e)
-                {
-                    LOG_ERROR("Error loading specification for: '%s' - %s", protocolName.c_str(), e.what());
-                }
-            }
+            *sit = cached->second;
+            ++unchanged;
+        } else {
+            pending.push_back(&*sit);
         }
     }
 
+    // Nothing added, changed or removed
+    if(msPreparedResourceDir && pending.empty() && unchanged == msSpecifications.size())
+    {
+        return false;
+    }
+
+    std::vector<char> loaded(pending.size(), 0);
+    boost::atomic<size_t> next(0);
+
+    SpecificationLoader<Specification> loader;
+    loader.specifications = &pending;
+    loader.loaded = &loaded;
+    loader.next = &next;
+
+    size_t numberOfThreads = std::min(pending.size(), std::min(static_cast<size_t>(boost::thread::hardware_concurrency()), MAX_LOADER_THREADS));
+    if(numberOfThreads > 1)
+    {
+        boost::thread_group threads;
+        for(size_t i = 0; i < numberOfThreads; ++i)
+        {
+            threads.create_thread(loader);
+        }
+        threads.join_all();
+    } else {
+        loader();
+    }
+
+    for(size_t i = 0; i < pending.size(); ++i)
+    {
+        Specification& specification = *pending[i];
+        specification.loaded = loaded[i];
+        if(loaded[i])
+        {
+            LOG_INFO("Register protocol %s", fs::path(specification.file).filename().string().c_str());
+            continue;
+        }
+
+        // Keep serving the previous version of a broken update
+        std::map<std::string, Specification>::const_iterator cached = msSpecifications.find(specification.file);
+        if(cached != msSpecifications.end() && cached->second.loaded)
+        {
+            LOG_WARN("Keeping previous version of protocol specification '%s'", specification.file.c_str());
+            specification.statemachine = cached->second.statemachine;
+            specification.loaded = true;
+        }
+    }
+
+    // Register in order of the resource directories, so that a later directory
+    // overrides a protocol of an earlier one
+    boost::shared_ptr<StateMachineMap> registered(new StateMachineMap());
+    std::map<std::string, Specification> compiled;
+    for(sit = specifications.begin(); sit != specifications.end(); ++sit)
+    {
+        // Failed specifications are kept as well, so that they are only retried once they change
+        compiled[sit->file] = *sit;
+        if(!sit->loaded)
+        {
+            continue;
+        }
+
+        std::string protocolName = fs::path(sit->file).filename().string();
+        if(registered->count(protocolName))
+        {
+            LOG_WARN("Protocol '%s' already registered - will use statemachine specification from '%s'", protocolName.c_str(), sit->file.c_str());
+        }
+        (*registered)[protocolName] = sit->statemachine;
+    }
+
+    msSpecifications.swap(compiled);
+    boost::atomic_store(&msStateMachines, StateMachineMapPtr(registered));
     msPreparedResourceDir = true;
+    return true;
 }
 
 StateMachine StateMachineFactory::getStateMachine(const std::string& protocol)
 {
     if(!msPreparedResourceDir)
     {
-        StateMachineFactory::prepareProtocolsFromResourceDirs();
+        boost::unique_lock<boost::mutex> lock(msMutex);
+        if(!msPreparedResourceDir)
+        {
+            StateMachineFactory::prepareProtocolsFromResourceDirs();
+        }
     }
 
-    std::map<std::string, StateMachine>::iterator it = msStateMachines.find(protocol);
+    StateMachineMapPtr statemachines = boost::atomic_load(&msStateMachines);
+    StateMachineMap::const_iterator it = statemachines->find(protocol);
 
-    if(it != msStateMachines.end())
+    if(it != statemachines->end())
     {
         return it->second;
     }
@@ -108,6 +256,57 @@ StateMachine StateMachineFactory::getStateMachine(const std::string& protocol)
     throw std::runtime_error("State machine for requested protocol does not exist");
 }
 
+bool StateMachineFactory::reload()
+{
+    boost::unique_lock<boost::mutex> lock(msMutex);
+    return prepareProtocolsFromResourceDirs();
+}
+
+void StateMachineFactory::watch(unsigned int intervalInMs)
+{
+    // Sleeping is the interruption point which ends the thread
+    while(true)
+    {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(intervalInMs));
+        try {
+            if(reload())
+            {
+                LOG_INFO("Reloaded protocol specifications");
+            }
+        } catch(const std::exception& e)
+        {
+            LOG_WARN("Reloading protocol specifications failed: %s", e.what());
+        }
+    }
+}
+
+void StateMachineFactory::startWatching(unsigned int intervalInMs)
+{
+    boost::unique_lock<boost::mutex> lock(msWatcherMutex);
+    if(msWatcher)
+    {
+        LOG_WARN("Protocol resource dirs are already watched");
+        return;
+    }
+    msWatcher.reset(new boost::thread(boost::bind(&StateMachineFactory::watch, intervalInMs)));
+}
+
+void StateMachineFactory::stopWatching()
+{
+    boost::unique_lock<boost::mutex> lock(msWatcherMutex);
+    if(msWatcher)
+    {
+        msWatcher->interrupt();
+        msWatcher->join();
+        msWatcher.reset();
+    }
+}
+
+bool StateMachineFactory::isWatching()
+{
+    boost::unique_lock<boost::mutex> lock(msWatcherMutex);
+    return msWatcher.get() != NULL;
+}
+
 } // end namespace acl
 } // end namespace fipa
-
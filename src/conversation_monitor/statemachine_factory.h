@@ -3,37 +3,83 @@
 
 #include <string>
 #include <map>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <sys/types.h>
 #include <fipa_acl/conversation_monitor/statemachine.h>
 #include <fipa_acl/conversation_monitor/state.h>
 
 namespace fipa {
 namespace acl {
 
-class StateMachineReader;
-
 class StateMachineFactory
 {
     private:
-        // Reader for state machine files
-        static StateMachineReader msStateMachineReader;
+        typedef std::map<std::string, StateMachine> StateMachineMap;
+        typedef boost::shared_ptr<const StateMachineMap> StateMachineMapPtr;
+
+        // Guards the resource directories and the loading of the protocols
+        static boost::mutex msMutex;
 
         static std::vector<std::string> msResourceDirs;
 
-        // Marked when the function prepareProtocolFromResourceDir has already been called
+        // Marked when the function prepareProtocolsFromResourceDirs has already been called
         // Used for lazy initialization in getStateMachine
-        static bool msPreparedResourceDir;
-        
-        static std::map<std::string, StateMachine> msStateMachines;
+        static boost::atomic<bool> msPreparedResourceDir;
+
+        // Loaded protocols, replaced as a whole on (re)loading and accessed with atomic_load/atomic_store
+        static StateMachineMapPtr msStateMachines;
+
+        /**
+         * A compiled specification file and the file status it has been compiled from
+         */
+        struct Specification
+        {
+            std::string file;
+            time_t modificationTime;
+            long modificationTimeNsec;
+            off_t size;
+            ino_t inode;
+            // False if the specification failed to compile
+            bool loaded;
+            StateMachine statemachine;
+
+            bool hasStatus(const Specification& other) const;
+        };
+
+        // Compiled specifications by file, so that a reload only compiles changed files
+        static std::map<std::string, Specification> msSpecifications;
+
+        // Background thread polling for changed specifications
+        static boost::shared_ptr<boost::thread> msWatcher;
+        static boost::mutex msWatcherMutex;
+
+        /**
+        * Instanciates all available machines from the resource directories,
+        * the specifications which are new or changed since the last call are loaded
+        * concurrently and the result is published at once.
+        * Requires msMutex to be locked
+        * \return true if new protocol definitions have been published
+        */
+        static bool prepareProtocolsFromResourceDirs();
+
+        /**
+        * Poll the resource directories for changes until interrupted
+        */
+        static void watch(unsigned int intervalInMs);
 
         /**
-        * Instanciates all available machines from the resource directory
+        * Add a resource directory, requires msMutex to be locked
         */
-        static void prepareProtocolsFromResourceDirs();
+        static void registerProtocolResourceDir(const std::string& resourceDir);
 
         /**
-        * Instanciates all available machines a resource directory
+        * List the specification files of a resource directory
         */
-        static void prepareProtocolsFromResourceDir(const std::string& directory);
+        static void listSpecifications(const std::string& directory, std::vector<Specification>& files);
 
 public: 
         /**
@@ -55,6 +101,30 @@ public:
          */
         static StateMachine getStateMachine(const std::string& protocol);
 
+        /**
+         * Recompile the specifications which changed on disk since they have been loaded and
+         * publish the new protocol definitions. Conversations which are started afterwards use
+         * the new definitions, running conversations keep the state machine they started with.
+         * A specification which fails to compile keeps its previous version.
+         * \return true if the protocol definitions changed
+         */
+        static bool reload();
+
+        /**
+         * Start a background thread which calls reload periodically
+         * \param intervalInMs polling interval in milliseconds
+         */
+        static void startWatching(unsigned int intervalInMs = 1000);
+
+        /**
+         * Stop the background thread started by startWatching
+         */
+        static void stopWatching();
+
+        /**
+         * Check if the background thread is running
+         */
+        static bool isWatching();
 };
 
 } // end namespace acl
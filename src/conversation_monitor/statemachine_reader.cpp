@@ -7,6 +7,7 @@
 
 #include <tinyxml.h>
 #include <boost/filesystem/path.hpp>
+#include <boost/filesystem/operations.hpp>
 
 #include "transition.h"
 
@@ -29,21 +30,16 @@ const std::string StateMachineReader::proxiedTo = std::string("proxied_to");
 
 StateMachine StateMachineReader::loadSpecification(const std::string& protocolSpec)
 {
+    TiXmlDocument file = TiXmlDocument(protocolSpec.c_str());
+    
+    if (!file.LoadFile())
     {
-        FILE* file = fopen(protocolSpec.c_str(), "r");
-        if(file)
+        // Check for existence only on failure, so that a valid file is opened once
+        if(!boost::filesystem::exists(protocolSpec))
         {
-            fclose(file);
-        } else {
             LOG_ERROR_S << "error loading the spec file: '" << protocolSpec << "'. File does not exist.";
             throw std::runtime_error("Error loading the specification file: '" + protocolSpec + "' -- file does not exist");
         }
-    }
-
-    TiXmlDocument file = TiXmlDocument(protocolSpec.c_str());
-    
-    if (!file.LoadFile())
-    {
         LOG_ERROR_S << "error loading the spec file: '" << protocolSpec << "'. Please use setProtocolResourceDir(const std::string&) instead to specify the location of your protocol files";
         throw std::runtime_error("Error loading the specification file: '" + protocolSpec + "' -- tinyxml failed to load the file");
     }
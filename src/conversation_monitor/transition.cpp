@@ -15,6 +15,7 @@ Transition::Transition()
     : mSenderRole()
     , mReceiverRole()
     , mPerformativeRegExp()
+    , mPerformativeRegex(mPerformativeRegExp)
     , mSourceStateId()
     , mTargetStateId()
 {
@@ -24,6 +25,7 @@ Transition::Transition(const Role& senderRole, const Role& receiverRole, const f
     : mSenderRole(senderRole)
     , mReceiverRole(receiverRole)
     , mPerformativeRegExp(PerformativeTxt[performative])
+    , mPerformativeRegex(mPerformativeRegExp)
     , mSourceStateId(sourceState)
     , mTargetStateId(targetState)
 {
@@ -34,6 +36,7 @@ Transition::Transition(const Role& senderRole, const Role& receiverRole, const s
     : mSenderRole(senderRole)
     , mReceiverRole(receiverRole)
     , mPerformativeRegExp(performativeRegExp)
+    , mPerformativeRegex(mPerformativeRegExp)
     , mSourceStateId(sourceState)
     , mTargetStateId(targetState)
 {
@@ -63,8 +66,7 @@ bool Transition::validateMessage(const ACLMessage& msg, const ACLMessage& valida
     // not the validator message one
     if (validation::PERFORMATIVE & flags)
     {
-        boost::regex performativeRegex(mPerformativeRegExp);
-        if(!regex_match(msg.getPerformative(), performativeRegex))
+        if(!matchesPerformative(msg.getPerformative()))
         {
             LOG_DEBUG("Performative validation failed: was '%s' but expected: '%s'", msg.getPerformative().c_str(), mPerformativeRegExp.c_str()); 
             return false;
@@ -161,7 +163,7 @@ std::string Transition::toString() const
 
 bool Transition::validateReceivers(const ACLMessage& msg, const RoleMapping& roleMapping) const
 {
-    AgentIDList actualReceivers = msg.getAllReceivers();
+    const AgentIDList& actualReceivers = msg.getAllReceivers();
     if(actualReceivers.empty())
     {
         std::string errorMsg = "No receivers set for this message: conversation id: " + msg.getConversationID() + " sender: " + msg.getSender().getName();
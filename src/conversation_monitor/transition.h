@@ -9,6 +9,7 @@
 
 #include <fipa_acl/bitefficient_message.h>
 #include <algorithm>
+#include <boost/regex.hpp>
 #include <fipa_acl/conversation_monitor/role.h>
 #include <fipa_acl/conversation_monitor/state.h>
 
@@ -35,6 +36,9 @@ class Transition
         /** performative of a message for this transition, regular expression string */
         std::string mPerformativeRegExp;
 
+        /** compiled performative regular expression */
+        boost::regex mPerformativeRegex;
+
         // Source state where this transition starts from
         StateId mSourceStateId;
         
@@ -82,13 +86,13 @@ class Transition
          * \brief setter methods for various fields of the class 
          *
          **/
-        void setPerformativeRegExp(const std::string& performativeRegExp) {  mPerformativeRegExp = performativeRegExp; }
+        void setPerformativeRegExp(const std::string& performativeRegExp) {  mPerformativeRegExp = performativeRegExp; mPerformativeRegex = boost::regex(performativeRegExp); }
         
         /** 
          * \brief setter methods for various fields of the class 
          *
          **/
-        void setPerformative(const fipa::acl::ACLMessage::Performative& performative) {  mPerformativeRegExp = fipa::acl::PerformativeTxt[performative]; }
+        void setPerformative(const fipa::acl::ACLMessage::Performative& performative) {  setPerformativeRegExp(fipa::acl::PerformativeTxt[performative]); }
 
         /**
          * Set the source state of this transition
@@ -127,6 +131,11 @@ class Transition
          **/
         std::string getPerformativeRegExp() const { return mPerformativeRegExp; }
 
+        /**
+         * Test whether the performative matches the performative regular expression of this transition
+         */
+        bool matchesPerformative(const std::string& performative) const { return boost::regex_match(performative, mPerformativeRegex); }
+
         /**
          * Get the state id of the source state
          */
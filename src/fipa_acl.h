@@ -3,7 +3,11 @@
 #include <fipa_acl/bitefficient_message.h>
 #include <fipa_acl/message_generator/acl_envelope.h>
 #include <fipa_acl/message_generator/envelope_generator.h>
+#include <fipa_acl/message_generator/transcoder.h>
 #include <fipa_acl/message_parser/envelope_parser.h>
+#include <fipa_acl/message_parser/parser_limits.h>
+#include <fipa_acl/message_parser/representation_detector.h>
+#include <fipa_acl/message_parser/letter_stream_decoder.h>
 #include <fipa_acl/message_generator/serialized_letter.h>
 #include <fipa_acl/conversation_monitor/conversation_monitor.h>
 
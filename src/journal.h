@@ -0,0 +1,7 @@
+#ifndef _FIPA_ACL_JOURNAL_H_
+#define _FIPA_ACL_JOURNAL_H_
+
+#include <fipa_acl/journal/journal_writer.h>
+#include <fipa_acl/journal/journal_reader.h>
+
+#endif // _FIPA_ACL_JOURNAL_H_
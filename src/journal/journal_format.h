@@ -0,0 +1,63 @@
+#ifndef FIPA_ACL_JOURNAL_FORMAT_H
+#define FIPA_ACL_JOURNAL_FORMAT_H
+
+#include <stdint.h>
+#include <string>
+#include <cstdio>
+
+namespace fipa {
+namespace acl {
+namespace journal {
+
+/**
+ * Layout of the journal files, all numbers are stored in big endian byte order
+ *
+ * A segment file starts with the magic string followed by records of the form
+ * \verbatim
+ [data size: 4][conversation-id size: 2][representation: 1][reserved: 1][timestamp in us: 8][conversation-id][data]
+ \endverbatim
+ *
+ * The index file of a segment contains one entry per record of the form
+ * \verbatim
+ [record offset: 8][timestamp in us: 8][conversation-id size: 2][conversation-id]
+ \endverbatim
+ */
+const std::string SEGMENT_MAGIC = "FIPAJRN1";
+const size_t RECORD_HEADER_SIZE = 16;
+const size_t INDEX_HEADER_SIZE = 18;
+const std::string SEGMENT_SUFFIX = ".journal";
+const std::string INDEX_SUFFIX = ".index";
+
+inline void putNumber(std::string& buffer, uint64_t value, size_t bytes)
+{
+    for(size_t i = bytes; i > 0; --i)
+    {
+        buffer += static_cast<char>((value >> (8*(i-1))) & 0xff);
+    }
+}
+
+inline uint64_t getNumber(const char* data, size_t bytes)
+{
+    uint64_t value = 0;
+    for(size_t i = 0; i < bytes; ++i)
+    {
+        value = (value << 8) | static_cast<unsigned char>(data[i]);
+    }
+    return value;
+}
+
+/**
+ * Name of the segment with the given number, without suffix
+ */
+inline std::string getSegmentName(uint32_t number)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "segment-%08u", number);
+    return name;
+}
+
+} // end namespace journal
+} // end namespace acl
+} // end namespace fipa
+
+#endif // FIPA_ACL_JOURNAL_FORMAT_H
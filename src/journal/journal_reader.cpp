@@ -0,0 +1,260 @@
+#include "journal_reader.h"
+#include "journal_format.h"
+#include <algorithm>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <base/logging.h>
+#include <boost/filesystem/path.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <fipa_acl/message_parser/envelope_parser.h>
+
+namespace fs = boost::filesystem;
+
+namespace fipa {
+namespace acl {
+
+JournalRecord::JournalRecord(const char* record)
+    : mRecord(record)
+{}
+
+representation::Type JournalRecord::getRepresentation() const
+{
+    return static_cast<representation::Type>(journal::getNumber(mRecord + 6, 1));
+}
+
+base::Time JournalRecord::getTimestamp() const
+{
+    return base::Time::fromMicroseconds(static_cast<int64_t>(journal::getNumber(mRecord + 8, 8)));
+}
+
+std::string JournalRecord::getConversationID() const
+{
+    return std::string(mRecord + journal::RECORD_HEADER_SIZE, journal::getNumber(mRecord + 4, 2));
+}
+
+const char* JournalRecord::getData() const
+{
+    return mRecord + journal::RECORD_HEADER_SIZE + journal::getNumber(mRecord + 4, 2);
+}
+
+size_t JournalRecord::getSize() const
+{
+    return journal::getNumber(mRecord, 4);
+}
+
+fipa::SerializedLetter JournalRecord::toSerializedLetter() const
+{
+    fipa::SerializedLetter letter;
+    letter.representation = getRepresentation();
+    letter.timestamp = getTimestamp();
+    letter.data.assign(getData(), getData() + getSize());
+    return letter;
+}
+
+Letter JournalRecord::deserialize() const
+{
+    Letter letter;
+    if(!EnvelopeParser::parseData(std::string(getData(), getSize()), letter, getRepresentation()))
+    {
+        throw std::runtime_error("JournalRecord: could not deserialize letter");
+    }
+    return letter;
+}
+
+JournalReader::JournalReader(const std::string& directory)
+{
+    if(!fs::is_directory(fs::path(directory)))
+    {
+        throw std::runtime_error("JournalReader: '" + directory + "' is not a journal directory");
+    }
+
+    // Segment names are zero padded, so that the lexical order is the order of writing
+    std::vector<std::string> segments;
+    fs::directory_iterator it(directory);
+    for(; it != fs::directory_iterator(); ++it)
+    {
+        if(it->path().extension().string() == journal::SEGMENT_SUFFIX)
+        {
+            segments.push_back(it->path().string());
+        }
+    }
+    std::sort(segments.begin(), segments.end());
+
+    try {
+        std::vector<std::string>::const_iterator sit = segments.begin();
+        for(; sit != segments.end(); ++sit)
+        {
+            std::string base = sit->substr(0, sit->size() - journal::SEGMENT_SUFFIX.size());
+            loadSegment(*sit, base + journal::INDEX_SUFFIX);
+        }
+    } catch(...)
+    {
+        std::vector<MappedFile>::iterator mit = mSegments.begin();
+        for(; mit != mSegments.end(); ++mit)
+        {
+            unmap(*mit);
+        }
+        throw;
+    }
+
+    std::stable_sort(mTimeline.begin(), mTimeline.end());
+}
+
+JournalReader::~JournalReader()
+{
+    std::vector<MappedFile>::iterator it = mSegments.begin();
+    for(; it != mSegments.end(); ++it)
+    {
+        unmap(*it);
+    }
+}
+
+std::vector<JournalRecord> JournalReader::getConversation(const std::string& conversationId) const
+{
+    std::vector<JournalRecord> records;
+    std::map<std::string, std::vector<size_t> >::const_iterator it = mConversations.find(conversationId);
+    if(it != mConversations.end())
+    {
+        records.reserve(it->second.size());
+        std::vector<size_t>::const_iterator pit = it->second.begin();
+        for(; pit != it->second.end(); ++pit)
+        {
+            records.push_back(mRecords[*pit]);
+        }
+    }
+    return records;
+}
+
+std::vector<JournalRecord> JournalReader::getRecords(const base::Time& from, const base::Time& to) const
+{
+    std::vector<JournalRecord> records;
+    std::vector< std::pair<int64_t, size_t> >::const_iterator it = std::lower_bound(mTimeline.begin(), mTimeline.end(),
+            std::make_pair(from.toMicroseconds(), static_cast<size_t>(0)));
+    for(; it != mTimeline.end() && it->first <= to.toMicroseconds(); ++it)
+    {
+        records.push_back(mRecords[it->second]);
+    }
+    return records;
+}
+
+std::vector<std::string> JournalReader::getConversationIDs() const
+{
+    std::vector<std::string> ids;
+    std::map<std::string, std::vector<size_t> >::const_iterator it = mConversations.begin();
+    for(; it != mConversations.end(); ++it)
+    {
+        ids.push_back(it->first);
+    }
+    return ids;
+}
+
+JournalReader::MappedFile JournalReader::map(const std::string& filename)
+{
+    MappedFile file;
+    file.data = NULL;
+    file.size = 0;
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        return file;
+    }
+
+    struct stat info;
+    if(fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        void* data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(data != MAP_FAILED)
+        {
+            file.data = static_cast<const char*>(data);
+            file.size = info.st_size;
+        }
+    }
+    close(fd);
+    return file;
+}
+
+void JournalReader::unmap(MappedFile& file)
+{
+    if(file.data)
+    {
+        munmap(const_cast<char*>(file.data), file.size);
+        file.data = NULL;
+        file.size = 0;
+    }
+}
+
+void JournalReader::addRecord(const char* record, int64_t timestamp, const std::string& conversationId)
+{
+    size_t position = mRecords.size();
+    mRecords.push_back(JournalRecord(record));
+    mConversations[conversationId].push_back(position);
+    mTimeline.push_back(std::make_pair(timestamp, position));
+}
+
+void JournalReader::loadSegment(const std::string& segmentFile, const std::string& indexFile)
+{
+    MappedFile segment = map(segmentFile);
+    if(!segment.data)
+    {
+        LOG_WARN("JournalReader: skipping empty or unreadable segment '%s'", segmentFile.c_str());
+        return;
+    }
+    mSegments.push_back(segment);
+
+    if(segment.size < journal::SEGMENT_MAGIC.size() || journal::SEGMENT_MAGIC.compare(0, std::string::npos, segment.data, journal::SEGMENT_MAGIC.size()) != 0)
+    {
+        throw std::runtime_error("JournalReader: '" + segmentFile + "' is not a journal segment");
+    }
+
+    // Records which are listed in the index do not need to be read
+    uint64_t offset = journal::SEGMENT_MAGIC.size();
+    MappedFile index = map(indexFile);
+    size_t position = 0;
+    while(index.data && position + journal::INDEX_HEADER_SIZE <= index.size)
+    {
+        const char* entry = index.data + position;
+        uint64_t recordOffset = journal::getNumber(entry, 8);
+        int64_t timestamp = journal::getNumber(entry + 8, 8);
+        size_t conversationIdSize = journal::getNumber(entry + 16, 2);
+        if(recordOffset != offset || position + journal::INDEX_HEADER_SIZE + conversationIdSize > index.size
+                || offset + journal::RECORD_HEADER_SIZE > segment.size)
+        {
+            break;
+        }
+
+        const char* record = segment.data + offset;
+        uint64_t recordSize = journal::RECORD_HEADER_SIZE + journal::getNumber(record + 4, 2) + journal::getNumber(record, 4);
+        if(offset + recordSize > segment.size)
+        {
+            break;
+        }
+
+        addRecord(record, timestamp, std::string(entry + journal::INDEX_HEADER_SIZE, conversationIdSize));
+        offset += recordSize;
+        position += journal::INDEX_HEADER_SIZE + conversationIdSize;
+    }
+    unmap(index);
+
+    // Scan the remaining records, which are missing in the index
+    while(offset + journal::RECORD_HEADER_SIZE <= segment.size)
+    {
+        const char* record = segment.data + offset;
+        uint64_t recordSize = journal::RECORD_HEADER_SIZE + journal::getNumber(record + 4, 2) + journal::getNumber(record, 4);
+        if(offset + recordSize > segment.size)
+        {
+            LOG_WARN("JournalReader: ignoring incomplete record at offset %lu in '%s'", (unsigned long) offset, segmentFile.c_str());
+            break;
+        }
+
+        JournalRecord journalRecord(record);
+        addRecord(record, journalRecord.getTimestamp().toMicroseconds(), journalRecord.getConversationID());
+        offset += recordSize;
+    }
+}
+
+} // end namespace acl
+} // end namespace fipa
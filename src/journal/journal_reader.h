@@ -0,0 +1,136 @@
+#ifndef FIPA_ACL_JOURNAL_READER_H
+#define FIPA_ACL_JOURNAL_READER_H
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <base/Time.hpp>
+#include <fipa_acl/message_generator/acl_envelope.h>
+#include <fipa_acl/message_generator/serialized_letter.h>
+
+namespace fipa {
+namespace acl {
+
+/**
+ * \class JournalRecord
+ * \brief View of a single record in a memory mapped journal segment
+ * \details The record remains valid as long as the JournalReader it has been retrieved from exists
+ */
+class JournalRecord
+{
+public:
+    JournalRecord(const char* record = NULL);
+
+    representation::Type getRepresentation() const;
+
+    base::Time getTimestamp() const;
+
+    std::string getConversationID() const;
+
+    /**
+     * Get the serialized letter, which is not copied
+     */
+    const char* getData() const;
+
+    /**
+     * Get the size of the serialized letter in bytes
+     */
+    size_t getSize() const;
+
+    /**
+     * Copy the record into a serialized letter
+     */
+    fipa::SerializedLetter toSerializedLetter() const;
+
+    /**
+     * Decode the letter
+     * \throws std::runtime_error if the letter cannot be decoded
+     */
+    Letter deserialize() const;
+
+private:
+    const char* mRecord;
+};
+
+/**
+ * \class JournalReader
+ * \brief Access the letters of a journal, which has been written with JournalWriter
+ * \details All segments of the journal are memory mapped and records are retrieved without copying.
+ * The index files are used to look up letters by conversation-id and time, records which are missing
+ * in the index, e.g. after a crash of the writer, are found by scanning the end of the segment.
+ * Incomplete records at the end of a segment are ignored.
+ *
+ * \verbatim
+ JournalReader reader("/var/log/agent/journal");
+ std::vector<JournalRecord> records = reader.getConversation("conversation-id");
+ for(size_t i = 0; i < records.size(); ++i)
+ {
+     ACLMessage msg = records[i].deserialize().getACLMessage();
+ }
+ \endverbatim
+ */
+class JournalReader
+{
+public:
+    /**
+     * Open a journal
+     * \param directory Directory of the journal
+     * \throws std::runtime_error if the journal cannot be opened
+     */
+    JournalReader(const std::string& directory);
+
+    ~JournalReader();
+
+    /**
+     * Get the number of records in the journal
+     */
+    size_t size() const { return mRecords.size(); }
+
+    /**
+     * Get the record at the given position, records are in the order they have been appended
+     */
+    const JournalRecord& getRecord(size_t position) const { return mRecords.at(position); }
+
+    /**
+     * Get all records of a conversation in the order they have been appended
+     */
+    std::vector<JournalRecord> getConversation(const std::string& conversationId) const;
+
+    /**
+     * Get all records with a timestamp in the interval [from, to], ordered by timestamp
+     */
+    std::vector<JournalRecord> getRecords(const base::Time& from, const base::Time& to) const;
+
+    /**
+     * Get the ids of all conversations in the journal
+     */
+    std::vector<std::string> getConversationIDs() const;
+
+private:
+    JournalReader(const JournalReader&);
+    JournalReader& operator=(const JournalReader&);
+
+    struct MappedFile
+    {
+        const char* data;
+        size_t size;
+    };
+
+    static MappedFile map(const std::string& filename);
+    static void unmap(MappedFile& file);
+
+    void addRecord(const char* record, int64_t timestamp, const std::string& conversationId);
+    void loadSegment(const std::string& segmentFile, const std::string& indexFile);
+
+    std::vector<MappedFile> mSegments;
+    std::vector<JournalRecord> mRecords;
+    std::map<std::string, std::vector<size_t> > mConversations;
+    // Timestamp and position of all records, ordered by timestamp
+    std::vector< std::pair<int64_t, size_t> > mTimeline;
+};
+
+} // end namespace acl
+} // end namespace fipa
+
+#endif // FIPA_ACL_JOURNAL_READER_H
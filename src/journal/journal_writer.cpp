@@ -0,0 +1,150 @@
+#include "journal_writer.h"
+#include "journal_format.h"
+#include <cstdlib>
+#include <stdexcept>
+#include <base/logging.h>
+#include <boost/filesystem/path.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <fipa_acl/message_generator/envelope_generator.h>
+
+namespace fs = boost::filesystem;
+
+namespace fipa {
+namespace acl {
+
+JournalWriter::JournalWriter(const std::string& directory, uint64_t maxSegmentSize)
+    : mDirectory(directory)
+    , mMaxSegmentSize(maxSegmentSize)
+    , mSegmentNumber(0)
+    , mSegmentSize(0)
+{
+    try {
+        fs::create_directories(fs::path(mDirectory));
+    } catch(const fs::filesystem_error& e)
+    {
+        throw std::runtime_error("JournalWriter: could not create directory '" + mDirectory + "': " + e.what());
+    }
+
+    // Continue after the last existing segment
+    fs::directory_iterator it(mDirectory);
+    for(; it != fs::directory_iterator(); ++it)
+    {
+        std::string name = it->path().filename().string();
+        if(name.compare(0, 8, "segment-") == 0 && it->path().extension().string() == journal::SEGMENT_SUFFIX)
+        {
+            uint32_t number = strtoul(name.c_str() + 8, NULL, 10);
+            if(number >= mSegmentNumber)
+            {
+                mSegmentNumber = number + 1;
+            }
+        }
+    }
+
+    openSegment();
+}
+
+JournalWriter::~JournalWriter()
+{
+    closeSegment();
+}
+
+void JournalWriter::append(const fipa::SerializedLetter& letter, const std::string& conversationId)
+{
+    if(conversationId.size() > 0xffff)
+    {
+        throw std::runtime_error("JournalWriter: conversation-id exceeds 65535 bytes");
+    }
+    if(letter.data.size() > 0xffffffffu)
+    {
+        throw std::runtime_error("JournalWriter: letter exceeds 4 GB");
+    }
+
+    int64_t timestamp = letter.timestamp.toMicroseconds();
+
+    boost::unique_lock<boost::mutex> lock(mMutex);
+    if(mSegmentSize > journal::SEGMENT_MAGIC.size() && mSegmentSize >= mMaxSegmentSize)
+    {
+        closeSegment();
+        ++mSegmentNumber;
+        openSegment();
+    }
+
+    mRecordHeader.clear();
+    journal::putNumber(mRecordHeader, letter.data.size(), 4);
+    journal::putNumber(mRecordHeader, conversationId.size(), 2);
+    journal::putNumber(mRecordHeader, letter.representation, 1);
+    journal::putNumber(mRecordHeader, 0, 1);
+    journal::putNumber(mRecordHeader, timestamp, 8);
+
+    mIndexEntry.clear();
+    journal::putNumber(mIndexEntry, mSegmentSize, 8);
+    journal::putNumber(mIndexEntry, timestamp, 8);
+    journal::putNumber(mIndexEntry, conversationId.size(), 2);
+    mIndexEntry += conversationId;
+
+    mSegment.write(mRecordHeader.data(), mRecordHeader.size());
+    mSegment.write(conversationId.data(), conversationId.size());
+    if(!letter.data.empty())
+    {
+        mSegment.write(reinterpret_cast<const char*>(&letter.data[0]), letter.data.size());
+    }
+    mIndex.write(mIndexEntry.data(), mIndexEntry.size());
+
+    if(!mSegment || !mIndex)
+    {
+        throw std::runtime_error("JournalWriter: failed to write to segment '" + journal::getSegmentName(mSegmentNumber) + "' in '" + mDirectory + "'");
+    }
+    mSegmentSize += mRecordHeader.size() + conversationId.size() + letter.data.size();
+}
+
+void JournalWriter::append(const Letter& letter, representation::Type representation)
+{
+    std::string conversationId;
+    try {
+        conversationId = letter.getACLMessage().getConversationID();
+    } catch(const std::runtime_error& e)
+    {
+        LOG_WARN("JournalWriter: letter without valid message is not indexed by conversation: %s", e.what());
+    }
+
+    append(fipa::SerializedLetter(letter, representation), conversationId);
+}
+
+void JournalWriter::flush()
+{
+    boost::unique_lock<boost::mutex> lock(mMutex);
+    mSegment.flush();
+    mIndex.flush();
+}
+
+void JournalWriter::openSegment()
+{
+    fs::path base = fs::path(mDirectory) / journal::getSegmentName(mSegmentNumber);
+    std::string segmentFile = base.string() + journal::SEGMENT_SUFFIX;
+    std::string indexFile = base.string() + journal::INDEX_SUFFIX;
+
+    mSegment.open(segmentFile.c_str(), std::ios::binary | std::ios::trunc);
+    mIndex.open(indexFile.c_str(), std::ios::binary | std::ios::trunc);
+    if(!mSegment || !mIndex)
+    {
+        throw std::runtime_error("JournalWriter: could not open segment '" + segmentFile + "'");
+    }
+
+    mSegment.write(journal::SEGMENT_MAGIC.data(), journal::SEGMENT_MAGIC.size());
+    mSegmentSize = journal::SEGMENT_MAGIC.size();
+}
+
+void JournalWriter::closeSegment()
+{
+    if(mSegment.is_open())
+    {
+        mSegment.close();
+    }
+    if(mIndex.is_open())
+    {
+        mIndex.close();
+    }
+}
+
+} // end namespace acl
+} // end namespace fipa
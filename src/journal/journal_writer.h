@@ -0,0 +1,92 @@
+#ifndef FIPA_ACL_JOURNAL_WRITER_H
+#define FIPA_ACL_JOURNAL_WRITER_H
+
+#include <stdint.h>
+#include <string>
+#include <fstream>
+#include <boost/thread/mutex.hpp>
+#include <fipa_acl/message_generator/acl_envelope.h>
+#include <fipa_acl/message_generator/serialized_letter.h>
+
+namespace fipa {
+namespace acl {
+
+/**
+ * \class JournalWriter
+ * \brief Append letters to a journal, i.e. a directory of segment files
+ * \details Each record holds the representation, the timestamp, the conversation-id and the serialized letter.
+ * For each segment an index file maps the conversation-id and timestamp of each record to its offset,
+ * so that a JournalReader can look up letters without reading the segments.
+ * A segment is closed once it exceeds the maximum segment size. Writing to an existing journal
+ * continues with a new segment.
+ *
+ * \verbatim
+ JournalWriter writer("/var/log/agent/journal");
+ writer.append(letter);
+ writer.flush();
+ \endverbatim
+ */
+class JournalWriter
+{
+public:
+    /**
+     * Open a journal for writing, the directory is created if it does not exist
+     * \param directory Directory of the journal
+     * \param maxSegmentSize Size in bytes after which a new segment is started
+     * \throws std::runtime_error if the journal cannot be opened
+     */
+    JournalWriter(const std::string& directory, uint64_t maxSegmentSize = 64*1024*1024);
+
+    ~JournalWriter();
+
+    /**
+     * Append a serialized letter
+     * \param letter Serialized letter
+     * \param conversationId Conversation-id of the contained message, which is used for the index
+     * \throws std::runtime_error if writing fails
+     */
+    void append(const fipa::SerializedLetter& letter, const std::string& conversationId);
+
+    /**
+     * Serialize and append a letter, the conversation-id is taken from the contained message
+     * \param letter Letter
+     * \param representation Representation to serialize the letter in
+     * \throws std::runtime_error if writing fails
+     */
+    void append(const Letter& letter, representation::Type representation = representation::BITEFFICIENT);
+
+    /**
+     * Flush all records to the files
+     */
+    void flush();
+
+    /**
+     * Get the directory of the journal
+     */
+    const std::string& getDirectory() const { return mDirectory; }
+
+private:
+    JournalWriter(const JournalWriter&);
+    JournalWriter& operator=(const JournalWriter&);
+
+    void openSegment();
+    void closeSegment();
+
+    std::string mDirectory;
+    uint64_t mMaxSegmentSize;
+
+    boost::mutex mMutex;
+    uint32_t mSegmentNumber;
+    uint64_t mSegmentSize;
+    std::ofstream mSegment;
+    std::ofstream mIndex;
+
+    // Buffers which are reused across records
+    std::string mRecordHeader;
+    std::string mIndexEntry;
+};
+
+} // end namespace acl
+} // end namespace fipa
+
+#endif // FIPA_ACL_JOURNAL_WRITER_H
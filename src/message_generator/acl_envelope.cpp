@@ -8,6 +8,7 @@
 
 #include <fipa_acl/message_parser/message_parser.h>
 #include <fipa_acl/message_generator/message_generator.h>
+#include <fipa_acl/message_generator/id_generator.h>
 
 using namespace boost::phoenix;
 using namespace boost::phoenix::arg_names;
@@ -17,8 +18,6 @@ using namespace fipa::acl::envelope;
 namespace fipa {
 namespace acl {
 
-uint32_t ACLEnvelope::mStampCounter = 0;
-
 ACLBaseEnvelope::ACLBaseEnvelope()
     : mParameters(NONE)
     , mACLRepresentation(representation::UNKNOWN)
@@ -324,7 +323,7 @@ void ACLEnvelope::stamp(const fipa::acl::AgentID& id)
 
     // Mandatory fields
     receivedObject.setBy(id.getName());
-    receivedObject.setDate(base::Time::now());
+    receivedObject.setDate(IDGenerator::getCoarseTime());
 
     receivedObject.setId(createLocalId());
 
@@ -352,10 +351,7 @@ bool ACLEnvelope::hasStamp(const fipa::acl::AgentID id) const
 
 ID ACLEnvelope::createLocalId()
 {
-    std::stringstream ss;
-    ss << ++mStampCounter;
-    ss << ":" << base::Time::now().toString();
-    return ss.str();
+    return IDGenerator::createLocalId(':');
 }
 
 ACLEnvelope ACLEnvelope::createDedicatedEnvelope(const AgentID& receiverId) const
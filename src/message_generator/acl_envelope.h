@@ -364,14 +364,10 @@ class ACLEnvelope
     // The payload data that is transported within this envelope
     std::string mPayload;
 
-    /**
-     * Count of stamps
-     */
-    static uint32_t mStampCounter;
-
     /**
      * Create an id for the received object
-     * <counter>:<timestamp>
+     * <counter>:<process prefix>
+     * \see IDGenerator
      */
     static ID createLocalId();
 
@@ -493,6 +489,7 @@ public:
      * Check whether the letter has already been stamped 
      * Iterates over all received objects for testing
      * \return True, if the agent id is set in one of the received objects, false otherwise
+     * \see DeduplicationCache to detect letters that arrive along multiple paths
      */
     bool hasStamp(fipa::acl::AgentID id) const;
 
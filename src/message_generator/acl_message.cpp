@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <string>
 #include "acl_message.h"
+#include "word_validation.h"
 #include <boost/assign/list_of.hpp>
 #include <boost/date_time.hpp>
 #include <boost/foreach.hpp>
@@ -36,6 +37,7 @@ std::map<ACLMessage::Performative, std::string> PerformativeTxt = boost::assign:
 	(ACLMessage::REQUEST_WHENEVER, "request-whenever")
 	(ACLMessage::SUBSCRIBE, "subscribe");
     
+// Keep in sync with the character classes in word_validation.cpp
 const std::string illegalWordChars = std::string("() ") + char(0x00);
 const std::string illegalWordStart = std::string("@#-0123456789"); 
 
@@ -65,7 +67,7 @@ ACLMessage::ACLMessage(Performative performative)
 
 ACLMessage::ACLMessage(const std::string& perf) 
 {
-    if ( (perf.find_first_of(illegalWordChars) != std::string::npos) || (illegalWordStart.find_first_of(perf.c_str()[0]) != std::string::npos) )
+    if (!word::isValid(perf))
     {
         char buffer[512];
         snprintf(buffer, 512,"Illegal characters in given performative: %s", perf.c_str());
@@ -132,7 +134,7 @@ void ACLMessage::setPerformative(Performative perf)
 
 void ACLMessage::setPerformative(const std::string& str) 
 {
-    if ( (str.find_first_of(illegalWordChars) != std::string::npos) || (illegalWordStart.find_first_of(str.c_str()[0]) != std::string::npos) )
+    if (!word::isValid(str))
     {
 
         char buffer[512];
@@ -197,7 +199,7 @@ void ACLMessage::clearReplyTo()
 
 void ACLMessage::setProtocol(const std::string& str) 
 {
-    if ( (str.find_first_of(illegalWordChars) != std::string::npos) || (illegalWordStart.find_first_of(str.c_str()[0]) != std::string::npos) )
+    if (!word::isValid(str))
     {
         char buffer[512];
         snprintf(buffer, 512, "Protocol name contains illegal characters: %s", str.c_str());
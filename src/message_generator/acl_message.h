@@ -163,7 +163,7 @@ public:
      * Retrieve list of all receivers
      * \return List of all receivers
      */
-    AgentIDList getAllReceivers() const { return mReceivers; }
+    const AgentIDList& getAllReceivers() const { return mReceivers; }
 
     /**
      * Set list of all receivers
@@ -271,6 +271,11 @@ public:
      * Set content 
      */
     void setContent(const std::string& content) { mContent = content; }
+
+    /**
+     * Set content from a buffer, i.e. copy size bytes starting at content
+     */
+    void setContent(const char* content, size_t size) { mContent.assign(content, size); }
    
     /**
      * Check whether the content has to be treated as binary or not. This is done by simply checking on the 
@@ -6,6 +6,7 @@
  */
 #include "agent_id.h"
 #include "acl_message.h"
+#include "word_validation.h"
 #include <iostream>
 #include <algorithm>
 #include <base/logging.h>
@@ -34,7 +35,7 @@ bool AgentID::isValid() const
 
 void AgentID::setName(const std::string& name)
 {
-    if ( (name.find_first_of(illegalWordChars) != std::string::npos) || (illegalWordStart.find_first_of(name.c_str()[0]) != std::string::npos) )
+    if (!word::isValid(name))
     {
         char buffer[128];
         snprintf(buffer, 128, "fipa::acl::AgentID: name '%s' contains invalid characters", name.c_str());
@@ -46,7 +47,7 @@ void AgentID::setName(const std::string& name)
 
 void AgentID::addAddress(const std::string& address)
 {
-    if ( (address.find_first_of(illegalWordChars) != std::string::npos) || (illegalWordStart.find_first_of(address.c_str()[0]) != std::string::npos) )
+    if (!word::isValid(address))
     {
         char buffer[128];
         snprintf(buffer, 128, "fipa::acl::AgentID: address '%s' contains invalid characters", address.c_str());
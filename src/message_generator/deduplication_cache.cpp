@@ -0,0 +1,107 @@
+#include "deduplication_cache.h"
+
+namespace fipa {
+namespace acl {
+
+static const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+static inline uint64_t fnv1a(uint64_t hash, const char* data, size_t size)
+{
+    const unsigned char* byte = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = byte + size;
+    for(; byte != end; ++byte)
+    {
+        hash ^= *byte;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static inline uint64_t fnv1a(uint64_t hash, const std::string& data)
+{
+    // Include the size to separate subsequent fields
+    uint64_t size = data.size();
+    hash = fnv1a(hash, reinterpret_cast<const char*>(&size), sizeof(size));
+    return fnv1a(hash, data.data(), data.size());
+}
+
+DeduplicationCache::DeduplicationCache(size_t maxEntries, const base::Time& window)
+    : mMaxEntries(maxEntries)
+    , mWindow(window)
+{}
+
+uint64_t DeduplicationCache::computeHash(const ACLEnvelope& letter)
+{
+    const ACLBaseEnvelope& baseEnvelope = letter.getBaseEnvelope();
+
+    uint64_t hash = FNV_OFFSET_BASIS;
+    hash = fnv1a(hash, baseEnvelope.getFrom().getName());
+
+    int64_t date = baseEnvelope.getDate().toMicroseconds();
+    hash = fnv1a(hash, reinterpret_cast<const char*>(&date), sizeof(date));
+
+    if(baseEnvelope.contains(envelope::RECEIVED_OBJECT))
+    {
+        hash = fnv1a(hash, baseEnvelope.getReceivedObject().getId());
+    }
+
+    return fnv1a(hash, letter.getPayload());
+}
+
+bool DeduplicationCache::isDuplicate(const ACLEnvelope& letter, const base::Time& now)
+{
+    return isDuplicate(computeHash(letter), now);
+}
+
+bool DeduplicationCache::isDuplicate(uint64_t hash, const base::Time& now)
+{
+    boost::unique_lock<boost::mutex> lock(mMutex);
+    expire(now);
+
+    if(mHashes.count(hash))
+    {
+        return true;
+    }
+
+    if(mMaxEntries == 0)
+    {
+        return false;
+    }
+
+    if(mEntries.size() >= mMaxEntries)
+    {
+        mHashes.erase(mEntries.front().second);
+        mEntries.pop_front();
+    }
+
+    mEntries.push_back(Entry(now, hash));
+    mHashes.insert(hash);
+    return false;
+}
+
+void DeduplicationCache::expire(const base::Time& now)
+{
+    base::Time oldest = now - mWindow;
+    while(!mEntries.empty() && mEntries.front().first < oldest)
+    {
+        mHashes.erase(mEntries.front().second);
+        mEntries.pop_front();
+    }
+}
+
+size_t DeduplicationCache::size() const
+{
+    boost::unique_lock<boost::mutex> lock(mMutex);
+    return mEntries.size();
+}
+
+void DeduplicationCache::clear()
+{
+    boost::unique_lock<boost::mutex> lock(mMutex);
+    mEntries.clear();
+    mHashes.clear();
+}
+
+} // end namespace acl
+} // end namespace fipa
@@ -0,0 +1,90 @@
+#ifndef FIPA_ACL_DEDUPLICATION_CACHE_H
+#define FIPA_ACL_DEDUPLICATION_CACHE_H
+
+#include <stdint.h>
+#include <deque>
+#include <set>
+#include <base/time.h>
+#include <boost/thread/mutex.hpp>
+#include <fipa_acl/message_generator/acl_envelope.h>
+
+namespace fipa {
+namespace acl {
+
+/**
+ * \class DeduplicationCache
+ * \brief Bounded, time-windowed cache to detect letters that reach an agent more than once, e.g.
+ * when being relayed along multiple paths
+ *
+ * A letter is identified by a 64-bit hash over the identifying fields of its base envelope
+ * and its payload, so that a duplicate can be dropped before the payload is parsed, i.e.
+ * before calling ACLEnvelope::getACLMessage
+ *
+ * The cache is thread-safe
+ */
+class DeduplicationCache
+{
+public:
+    /**
+     * Create cache
+     * \param maxEntries Maximum number of letters to remember, the oldest entries are dropped first
+     * \param window Duration for which a letter is remembered
+     */
+    DeduplicationCache(size_t maxEntries = 1024, const base::Time& window = base::Time::fromSeconds(60));
+
+    /**
+     * Compute the hash of a letter, i.e. FNV-1a over from, date and received
+     * object id of the base envelope as well as the payload
+     * Extra envelopes are not considered, since they differ between relay paths
+     * \return hash value identifying the letter
+     */
+    static uint64_t computeHash(const ACLEnvelope& letter);
+
+    /**
+     * Test whether the letter has been seen within the time window
+     * and remember it otherwise
+     * \param letter Letter to test
+     * \param now Current time
+     * \return true if the letter is a duplicate, false otherwise
+     */
+    bool isDuplicate(const ACLEnvelope& letter, const base::Time& now = base::Time::now());
+
+    /**
+     * Test whether the letter hash has been seen within the time window
+     * and remember it otherwise
+     * \see computeHash
+     */
+    bool isDuplicate(uint64_t hash, const base::Time& now = base::Time::now());
+
+    /**
+     * Get the number of remembered letters
+     */
+    size_t size() const;
+
+    /**
+     * Forget all letters
+     */
+    void clear();
+
+private:
+    /**
+     * Remove entries that are outside of the time window, or exceed the maximum number of entries
+     */
+    void expire(const base::Time& now);
+
+    typedef std::pair<base::Time, uint64_t> Entry;
+
+    size_t mMaxEntries;
+    base::Time mWindow;
+
+    // Entries in order of insertion, i.e. the oldest first
+    std::deque<Entry> mEntries;
+    // Hashes of the remembered letters for lookup
+    std::set<uint64_t> mHashes;
+
+    mutable boost::mutex mMutex;
+};
+
+} // end namespace acl
+} // end namespace fipa
+#endif // FIPA_ACL_DEDUPLICATION_CACHE_H
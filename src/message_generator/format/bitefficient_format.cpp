@@ -1,6 +1,7 @@
 #include "bitefficient_format.h"
 #include <boost/algorithm/string.hpp>
 #include <sstream>
+#include <fipa_acl/message_parser/date_time.h>
 #include <base/logging.h>
 
 namespace fipa {
@@ -33,23 +34,25 @@ std::string BitefficientFormat::getBinDateTimeToken(const std::string& date1)
 
 std::string BitefficientFormat::getBinDateTimeToken(const base::Time& time)
 {
-    return char(0x20) + getBinDate(time);
+    char token[1 + DateTime::BIN_DATE_SIZE];
+    token[0] = char(0x20);
+    writeBinDate(time, token + 1);
+    return std::string(token, sizeof(token));
 }
 
 std::string BitefficientFormat::getBinDate(const base::Time& baseTime)
 {
+    char date[DateTime::BIN_DATE_SIZE];
+    writeBinDate(baseTime, date);
+    return std::string(date, sizeof(date));
+}
 
-    std::string time = baseTime.toString(base::Time::Milliseconds);
-
-    // Input format should be "%Y%m%d-%H:%M:%S"
-    // Strip ':' and '-' to allow from_iso_string to work
-    boost::erase_all(time,":");
-    boost::erase_all(time,"-");
-
-    // extend millisecond field to 4 digits
-    time.insert(14,sizeof(char),'0');
-
-    return getBinDate(time);
+void BitefficientFormat::writeBinDate(const base::Time& baseTime, char* buffer)
+{
+    // Same layout as getBinDate(const std::string&) applied to
+    // baseTime.toString(base::Time::Milliseconds) with ':' and '-' stripped
+    // and the millisecond field extended to 4 digits, i.e. YYYYMMDDhhmmss0mmm
+    DateTime::encodeBinDate(baseTime, buffer);
 }
 
 std::string BitefficientFormat::getBinDate(const std::string& date1)
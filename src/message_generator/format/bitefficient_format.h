@@ -61,6 +61,13 @@ public:
      */
     static std::string getBinDate(const base::Time& time);
 
+    /**
+     * Write the bitefficient encoding for base time into the given buffer,
+     * which has to hold at least DateTime::BIN_DATE_SIZE bytes
+     * The encoding is computed arithmetically, i.e. without formatting the time as string
+     */
+    static void writeBinDate(const base::Time& time, char* buffer);
+
     /**
     \brief takes the string representing the date and passes it's digits 2 by 2(as length 2 sugstrings) to the byte encoding function
     it did not explicitly specify but it was induced from the way it was stated that the date is to be encoded as a coded number(comment 9 of the specification)
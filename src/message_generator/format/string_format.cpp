@@ -1,82 +1,173 @@
 #include "string_format.h"
-#include <sstream>
+#include <stdio.h>
 
 namespace fipa {
 namespace acl {
 
 std::string StringFormat::getAgentIdentifier(const AgentID& agent)
 {
-    std::string agentTxt = "(agent-identifier";
-    agentTxt += ":name" + getWord(agent.getName());
+    std::string agentTxt;
+    agentTxt.reserve(getAgentIdentifierLength(agent));
+    appendAgentIdentifier(agentTxt, agent);
+    return agentTxt;
+}
+
+std::string StringFormat::getAgentIdentifierSequence(const AgentIDList& agentList)
+{
+    std::string list;
+    list.reserve(getAgentIdentifierListLength(agentList) + 10);
+    appendAgentIdentifierSequence(list, agentList);
+    return list;
+}
+
+std::string StringFormat::getAgentIdentifierSet(const AgentIDList& agentList)
+{
+    std::string list;
+    list.reserve(getAgentIdentifierListLength(agentList) + 5);
+    appendAgentIdentifierSet(list, agentList);
+    return list;
+}
+
+std::string StringFormat::getAgentIdentifierList(const AgentIDList& agentList)
+{
+    std::string list;
+    list.reserve(getAgentIdentifierListLength(agentList));
+    appendAgentIdentifierList(list, agentList);
+    return list;
+}
+
+std::string StringFormat::getUrlSequence(const Addresses& addresses)
+{
+    std::string sequence;
+    appendUrlSequence(sequence, addresses);
+    return sequence;
+}
+
+std::string StringFormat::getString(const std::string& txt)
+{
+    std::string encoded;
+    encoded.reserve(getStringLength(txt));
+    appendString(encoded, txt);
+    return encoded;
+}
+
+void StringFormat::appendAgentIdentifier(std::string& out, const AgentID& agent)
+{
+    out += "(agent-identifier";
+    out += ":name";
+    out += getWord(agent.getName());
     if(!agent.getAddresses().empty())
     {
-        agentTxt += ":addresses" + getUrlSequence(agent.getAddresses());
+        out += ":addresses";
+        appendUrlSequence(out, agent.getAddresses());
     }
     if(!agent.getResolvers().empty())
     {
-        agentTxt += ":resolvers" + getAgentIdentifierSequence(agent.getResolvers());
+        out += ":resolvers";
+        appendAgentIdentifierSequence(out, agent.getResolvers());
     }
 
     std::vector<UserdefParam>::const_iterator cit = agent.getUserdefParams().begin();
     for(; cit != agent.getUserdefParams().end(); ++cit)
     {
-        agentTxt += getUserdefinedParameter(cit->getName());
-        agentTxt += getExpression(cit->getValue());
+        out += getUserdefinedParameter(cit->getName());
+        appendString(out, cit->getValue());
     }
-    agentTxt += ")";
-
-    return agentTxt;
+    out += ")";
 }
 
-std::string StringFormat::getAgentIdentifierSequence(const AgentIDList& agentList)
+void StringFormat::appendAgentIdentifierSequence(std::string& out, const AgentIDList& agentList)
 {
-    std::string list = "(sequence";
-    list += getAgentIdentifierList(agentList);
-    list += ")";
-    return list;
+    out += "(sequence";
+    appendAgentIdentifierList(out, agentList);
+    out += ")";
 }
 
-std::string StringFormat::getAgentIdentifierSet(const AgentIDList& agentList)
+void StringFormat::appendAgentIdentifierSet(std::string& out, const AgentIDList& agentList)
 {
-    std::string list = "(set";
-    list += getAgentIdentifierList(agentList);
-    list += ")";
-    return list;
+    out += "(set";
+    appendAgentIdentifierList(out, agentList);
+    out += ")";
 }
 
-std::string StringFormat::getAgentIdentifierList(const AgentIDList& agentList)
+void StringFormat::appendAgentIdentifierList(std::string& out, const AgentIDList& agentList)
 {
-    std::string list = "";
     AgentIDList::const_iterator cit = agentList.begin();
     for(; cit != agentList.end(); ++cit)
     {
-        list += getAgentIdentifier(*cit);
+        appendAgentIdentifier(out, *cit);
     }
-    return list;
 }
 
-std::string StringFormat::getUrlSequence(const Addresses& addresses)
+void StringFormat::appendUrlSequence(std::string& out, const Addresses& addresses)
 {
-    std::string sequence = "(sequence";
+    out += "(sequence";
     Addresses::const_iterator cit = addresses.begin();
     for(; cit != addresses.end(); ++cit)
     {
          // For ease of parsing, separate URLs with a space
-        sequence += getUrl(*cit) + " ";
+        out += getUrl(*cit);
+        out += " ";
     }
-    sequence += ")";
-    return sequence;
+    out += ")";
 }
 
-std::string StringFormat::getString(const std::string& txt)
+void StringFormat::appendString(std::string& out, const std::string& txt)
 {
-    size_t size = txt.size();
-    std::stringstream ss;
-    ss << "#" << size << "\"" << txt;
+    char prefix[32];
+    int prefixSize = snprintf(prefix, sizeof(prefix), "#%lu\"", (unsigned long) txt.size());
+    out.append(prefix, prefixSize);
+    out.append(txt.data(), txt.size());
+}
 
-    return ss.str();
+size_t StringFormat::getAgentIdentifierLength(const AgentID& agent)
+{
+    // "(agent-identifier:name" + ")"
+    size_t length = 23 + agent.getName().size();
+    if(!agent.getAddresses().empty())
+    {
+        // ":addresses(sequence" + ")"
+        length += 20;
+        Addresses::const_iterator ait = agent.getAddresses().begin();
+        for(; ait != agent.getAddresses().end(); ++ait)
+        {
+            length += ait->size() + 1;
+        }
+    }
+    if(!agent.getResolvers().empty())
+    {
+        // ":resolvers(sequence" + ")"
+        length += 20 + getAgentIdentifierListLength(agent.getResolvers());
+    }
+    std::vector<UserdefParam>::const_iterator cit = agent.getUserdefParams().begin();
+    for(; cit != agent.getUserdefParams().end(); ++cit)
+    {
+        length += cit->getName().size() + getStringLength(cit->getValue());
+    }
+    return length;
 }
 
+size_t StringFormat::getAgentIdentifierListLength(const AgentIDList& agentList)
+{
+    size_t length = 0;
+    AgentIDList::const_iterator cit = agentList.begin();
+    for(; cit != agentList.end(); ++cit)
+    {
+        length += getAgentIdentifierLength(*cit);
+    }
+    return length;
+}
+
+size_t StringFormat::getStringLength(const std::string& txt)
+{
+    size_t digits = 1;
+    for(size_t size = txt.size(); size >= 10; size /= 10)
+    {
+        ++digits;
+    }
+    // '#' + digits + '"' + txt
+    return digits + 2 + txt.size();
+}
 
 } // end namespace acl
 } // end namespace fipa
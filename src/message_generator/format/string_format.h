@@ -5,11 +5,48 @@
 namespace fipa {
 namespace acl {
 
+/**
+ * \class StringFormat
+ * \brief Encoding of the elements of the string representation
+ *
+ * The get* functions return the encoded element, while the append* functions write
+ * it directly to the end of an output buffer to avoid temporaries
+ */
 class StringFormat
 {
 public:
     static std::string getAgentIdentifier(const AgentID& agentID);
 
+    static void appendAgentIdentifier(std::string& out, const AgentID& agentID);
+
+    static void appendAgentIdentifierSequence(std::string& out, const AgentIDList& agentList);
+
+    static void appendAgentIdentifierSet(std::string& out, const AgentIDList& agentList);
+
+    static void appendAgentIdentifierList(std::string& out, const AgentIDList& agentList);
+
+    static void appendUrlSequence(std::string& out, const Addresses& addresses);
+
+    /**
+     * Append a byte-length encoded string, i.e. #<size>"<txt>
+     */
+    static void appendString(std::string& out, const std::string& txt);
+
+    /**
+     * Get the (upper bound of the) encoded size of an agent identifier
+     */
+    static size_t getAgentIdentifierLength(const AgentID& agentID);
+
+    /**
+     * Get the (upper bound of the) encoded size of an agent identifier list
+     */
+    static size_t getAgentIdentifierListLength(const AgentIDList& agentList);
+
+    /**
+     * Get the encoded size of a byte-length encoded string
+     */
+    static size_t getStringLength(const std::string& txt);
+
     /**
      * Get encoded agent identifier list (with sequence label)
      */
@@ -1,45 +1,88 @@
 #include "string_message_format.h"
 #include "string_format.h"
 
-#include <sstream>
 #include <boost/algorithm/string.hpp>
 
 namespace fipa {
 namespace acl {
 
+namespace {
+    // Upper bound for the encoded size of a message field keyword including
+    // separator and surrounding parentheses
+    const size_t FIELD_OVERHEAD = 32;
+
+    void appendField(std::string& out, MessageField::Type field)
+    {
+        out += ':';
+        out += MessageField::MessageFieldTxt[field];
+    }
+}
+
+size_t StringMessageFormat::getLength(const ACLMessage& aclMsg)
+{
+    size_t length = 2 + aclMsg.getPerformative().size();
+
+    length += FIELD_OVERHEAD + StringFormat::getAgentIdentifierLength(aclMsg.getSender());
+    length += FIELD_OVERHEAD + StringFormat::getAgentIdentifierListLength(aclMsg.getAllReceivers());
+    length += FIELD_OVERHEAD + StringFormat::getStringLength(*aclMsg.getContentPtr());
+    length += FIELD_OVERHEAD + StringFormat::getStringLength(aclMsg.getReplyWith());
+    // reply-by: YYYYMMDDTHHMMSSmmm
+    length += FIELD_OVERHEAD + 32;
+    length += FIELD_OVERHEAD + StringFormat::getStringLength(aclMsg.getInReplyTo());
+    length += FIELD_OVERHEAD + StringFormat::getAgentIdentifierListLength(aclMsg.getAllReplyTo());
+    length += FIELD_OVERHEAD + StringFormat::getStringLength(aclMsg.getLanguage());
+    length += FIELD_OVERHEAD + StringFormat::getStringLength(aclMsg.getEncoding());
+    length += FIELD_OVERHEAD + StringFormat::getStringLength(aclMsg.getOntology());
+    length += FIELD_OVERHEAD + aclMsg.getProtocol().size();
+    length += FIELD_OVERHEAD + StringFormat::getStringLength(aclMsg.getConversationID());
+
+    const std::vector<fipa::acl::UserdefParam>& parameters = aclMsg.getUserdefParams();
+    std::vector<fipa::acl::UserdefParam>::const_iterator cit = parameters.begin();
+    for(; cit != parameters.end(); ++cit)
+    {
+        length += FIELD_OVERHEAD + cit->getName().size() + StringFormat::getStringLength(cit->getValue());
+    }
+    return length;
+}
 
 std::string StringMessageFormat::apply(const ACLMessage& aclMsg) const
 {
     using namespace MessageField;
 
-    std::string msg = "(";
+    // Reserve once, so that all fields -- in particular the content -- are
+    // copied only a single time into the output
+    std::string msg;
+    msg.reserve(getLength(aclMsg));
+
+    msg += "(";
     msg += aclMsg.getPerformative();
 
     const AgentID& sender = aclMsg.getSender();
     if(sender.isValid())
     {
-        msg += ":" + MessageFieldTxt[SENDER] + StringFormat::getAgentIdentifier(sender);
+        appendField(msg, SENDER);
+        StringFormat::appendAgentIdentifier(msg, sender);
     }
 
     const AgentIDList& receivers = aclMsg.getAllReceivers();
     if(!receivers.empty())
     {
-        msg += ":" + MessageFieldTxt[RECEIVER] + StringFormat::getAgentIdentifierSet(receivers);
+        appendField(msg, RECEIVER);
+        StringFormat::appendAgentIdentifierSet(msg, receivers);
     }
 
-    if(!aclMsg.getContentPtr()->empty())
+    const std::string& content = *aclMsg.getContentPtr();
+    if(!content.empty())
     {
-        size_t size = aclMsg.getContentPtr()->size();
-        std::stringstream ss;
-        ss << size;
-
-        msg += ":" + MessageFieldTxt[CONTENT] + StringFormat::getString(*aclMsg.getContentPtr());
+        appendField(msg, CONTENT);
+        StringFormat::appendString(msg, content);
     }
 
     const std::string& replyWith = aclMsg.getReplyWith();
     if(!replyWith.empty())
     {
-        msg += ":" + MessageFieldTxt[REPLY_WITH] + StringFormat::getExpression(replyWith);
+        appendField(msg, REPLY_WITH);
+        StringFormat::appendString(msg, replyWith);
     }
 
 
@@ -49,49 +92,57 @@ std::string StringMessageFormat::apply(const ACLMessage& aclMsg) const
         std::string replyByString = replyBy.toString(base::Time::Milliseconds, "%Y%m%dT%H%M%S");
         boost::erase_all(replyByString,":");
 
-        msg += ":" + MessageFieldTxt[REPLY_BY] + replyByString;
+        appendField(msg, REPLY_BY);
+        msg += replyByString;
     }
 
     const std::string& inReplyTo = aclMsg.getInReplyTo();
     if(!inReplyTo.empty())
     {
-        msg += ":" + MessageFieldTxt[IN_REPLY_TO] + StringFormat::getExpression(inReplyTo);
+        appendField(msg, IN_REPLY_TO);
+        StringFormat::appendString(msg, inReplyTo);
     }
 
     const AgentIDList& replyTo = aclMsg.getAllReplyTo();
     if(!replyTo.empty())
     {
-        msg += ":" + MessageFieldTxt[REPLY_TO] + StringFormat::getAgentIdentifierSet(replyTo);
+        appendField(msg, REPLY_TO);
+        StringFormat::appendAgentIdentifierSet(msg, replyTo);
     }
 
     const std::string& language = aclMsg.getLanguage();
     if(!language.empty())
     {
-        msg += ":" + MessageFieldTxt[LANGUAGE] + StringFormat::getExpression(language);
+        appendField(msg, LANGUAGE);
+        StringFormat::appendString(msg, language);
     }
 
     const std::string& encoding = aclMsg.getEncoding();
     if(!encoding.empty())
     {
-        msg += ":" + MessageFieldTxt[ENCODING] + StringFormat::getExpression(encoding);
+        appendField(msg, ENCODING);
+        StringFormat::appendString(msg, encoding);
     }
 
     const std::string& ontology = aclMsg.getOntology();
     if(!ontology.empty())
     {
-        msg += ":" + MessageFieldTxt[ONTOLOGY] + StringFormat::getExpression(ontology);
+        appendField(msg, ONTOLOGY);
+        StringFormat::appendString(msg, ontology);
     }
 
     const std::string& protocol = aclMsg.getProtocol();
     if(!protocol.empty())
     {
-        msg += ":" + MessageFieldTxt[PROTOCOL] + StringFormat::getWord(protocol);
+        appendField(msg, PROTOCOL);
+        msg += StringFormat::getWord(protocol);
     }
 
     const std::string& conversationId = aclMsg.getConversationID();
     if(!conversationId.empty())
     {
-        msg += ":" + MessageFieldTxt[CONVERSATION_ID] + StringFormat::getExpression(conversationId);
+        appendField(msg, CONVERSATION_ID);
+        StringFormat::appendString(msg, conversationId);
     }
 
     const std::vector<fipa::acl::UserdefParam>& parameters = aclMsg.getUserdefParams();
@@ -100,7 +151,11 @@ std::string StringMessageFormat::apply(const ACLMessage& aclMsg) const
     {
         // As user defined parameters are Words, they can contain spaces and it is not clear,
         // where the actual parameter starts. Therefore, we use parentheses around the expression.
-        msg += ":X-" + cit->getName() + "(" + StringFormat::getExpression(cit->getValue()) + ")";
+        msg += ":X-";
+        msg += cit->getName();
+        msg += "(";
+        StringFormat::appendString(msg, cit->getValue());
+        msg += ")";
     }
     msg += ")";
 
@@ -13,6 +13,12 @@ public:
      * \return the formatted message
      */
     std::string apply(const ACLMessage& msg) const;
+
+    /**
+     * Get the upper bound of the encoded size of the message, which is used to
+     * reserve the output buffer
+     */
+    static size_t getLength(const ACLMessage& msg);
 };
 
 } // end namespace acl
@@ -0,0 +1,104 @@
+#include "id_generator.h"
+#include <pthread.h>
+#include <time.h>
+#include <uuid/uuid.h>
+#include <boost/atomic.hpp>
+#include <boost/thread/once.hpp>
+
+namespace fipa {
+namespace acl {
+
+static std::string prefix;
+static boost::atomic<uint64_t> counter(0);
+static boost::once_flag prefixInitialized = BOOST_ONCE_INIT;
+
+void IDGenerator::generatePrefix()
+{
+    uuid_t uuid;
+    uuid_generate(uuid);
+
+    char uuidString[37];
+    uuid_unparse(uuid, uuidString);
+    prefix = std::string(uuidString);
+}
+
+void IDGenerator::initPrefix()
+{
+    generatePrefix();
+    // A forked child inherits prefix and counter, so it requires
+    // a new prefix to keep its ids distinct from the parent's
+    // (the child is single threaded when the handler is called)
+    pthread_atfork(NULL, NULL, &IDGenerator::generatePrefix);
+}
+
+const std::string& IDGenerator::getPrefix()
+{
+    boost::call_once(prefixInitialized, &IDGenerator::initPrefix);
+    return prefix;
+}
+
+uint64_t IDGenerator::nextCount()
+{
+    return counter.fetch_add(1, boost::memory_order_relaxed) + 1;
+}
+
+/**
+ * Write decimal representation of number into buffer, ending at end
+ * \return pointer to the first digit
+ */
+static char* writeDecimal(uint64_t number, char* end)
+{
+    char* begin = end;
+    do {
+        *--begin = char('0' + number % 10);
+        number /= 10;
+    } while(number != 0);
+    return begin;
+}
+
+std::string IDGenerator::createId()
+{
+    const std::string& idPrefix = getPrefix();
+
+    char buffer[21];
+    char* end = buffer + sizeof(buffer);
+    char* begin = writeDecimal(nextCount(), end);
+
+    std::string id;
+    id.reserve(idPrefix.size() + 1 + (end - begin));
+    id.append(idPrefix);
+    id += '-';
+    id.append(begin, end);
+    return id;
+}
+
+std::string IDGenerator::createLocalId(char separator)
+{
+    const std::string& idPrefix = getPrefix();
+
+    char buffer[21];
+    char* end = buffer + sizeof(buffer);
+    char* begin = writeDecimal(nextCount(), end);
+
+    std::string id;
+    id.reserve((end - begin) + 1 + idPrefix.size());
+    id.append(begin, end);
+    id += separator;
+    id.append(idPrefix);
+    return id;
+}
+
+base::Time IDGenerator::getCoarseTime()
+{
+#ifdef CLOCK_REALTIME_COARSE
+    struct timespec now;
+    if(clock_gettime(CLOCK_REALTIME_COARSE, &now) == 0)
+    {
+        return base::Time::fromMicroseconds(static_cast<int64_t>(now.tv_sec)*1000000 + now.tv_nsec/1000);
+    }
+#endif
+    return base::Time::now();
+}
+
+} // end namespace acl
+} // end namespace fipa
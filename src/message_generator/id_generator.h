@@ -0,0 +1,58 @@
+#ifndef FIPA_ACL_ID_GENERATOR_H
+#define FIPA_ACL_ID_GENERATOR_H
+
+#include <stdint.h>
+#include <string>
+#include <base/time.h>
+
+namespace fipa {
+namespace acl {
+
+/**
+ * Generator for unique ids, e.g. for received objects and conversations
+ *
+ * An id consists of a random per-process prefix (generated from a uuid once and
+ * regenerated in a forked child) and an atomic counter, so that creating an id
+ * requires neither a system call nor a lock, while ids remain unique across processes
+ */
+class IDGenerator
+{
+public:
+    /**
+     * Retrieve the per-process prefix, i.e. a random uuid string
+     */
+    static const std::string& getPrefix();
+
+    /**
+     * Retrieve the next value of the process-wide counter (thread-safe)
+     */
+    static uint64_t nextCount();
+
+    /**
+     * Create a new unique id
+     * \return <prefix>-<counter>
+     */
+    static std::string createId();
+
+    /**
+     * Create a new unique id with the counter first
+     * \return <counter><separator><prefix>
+     */
+    static std::string createLocalId(char separator = ':');
+
+    /**
+     * Retrieve the current time from the coarse realtime clock, i.e. with
+     * the resolution of the system tick but without a system call
+     * Falls back to base::Time::now() if no coarse clock is available
+     */
+    static base::Time getCoarseTime();
+
+private:
+    static void initPrefix();
+    static void generatePrefix();
+};
+
+} // end namespace acl
+} // end namespace fipa
+
+#endif // FIPA_ACL_ID_GENERATOR_H
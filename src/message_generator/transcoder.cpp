@@ -0,0 +1,82 @@
+#include "transcoder.h"
+#include "message_generator.h"
+#include <fipa_acl/message_parser/message_parser.h>
+#include <fipa_acl/message_parser/representation_detector.h>
+
+namespace fipa {
+namespace acl {
+
+bool Transcoder::transcode(const std::string& source, representation::Type sourceRepresentation,
+        std::string& target, representation::Type targetRepresentation)
+{
+    if(sourceRepresentation == representation::AUTO)
+    {
+        sourceRepresentation = RepresentationDetector::detectMessage(source);
+        if(sourceRepresentation == representation::UNKNOWN)
+        {
+            return false;
+        }
+    }
+
+    if(sourceRepresentation == targetRepresentation)
+    {
+        target = source;
+        return true;
+    }
+
+    ACLMessage msg;
+    if(!MessageParser::parseData(source, msg, sourceRepresentation))
+    {
+        return false;
+    }
+    // Swap instead of assigning to avoid copying the encoded message
+    MessageGenerator::create(msg, targetRepresentation).swap(target);
+    return true;
+}
+
+bool Transcoder::transcode(Letter& letter, representation::Type targetRepresentation)
+{
+    representation::Type sourceRepresentation = letter.flattened().getACLRepresentation();
+    if(sourceRepresentation == representation::UNKNOWN)
+    {
+        sourceRepresentation = representation::AUTO;
+    }
+
+    std::string payload;
+    if(!transcode(letter.getPayload(), sourceRepresentation, payload, targetRepresentation))
+    {
+        return false;
+    }
+    letter.setPayload(payload);
+
+    ACLBaseEnvelope baseEnvelope = letter.getBaseEnvelope();
+    baseEnvelope.setACLRepresentation(targetRepresentation);
+    baseEnvelope.setPayloadLength(payload.size());
+    letter.setBaseEnvelope(baseEnvelope);
+
+    // Extra envelopes override the base envelope, so they have to be updated as well
+    ACLBaseEnvelopeList extraEnvelopes = letter.getExtraEnvelopes();
+    bool updated = false;
+    ACLBaseEnvelopeList::iterator it = extraEnvelopes.begin();
+    for(; it != extraEnvelopes.end(); ++it)
+    {
+        if(it->contains(envelope::ACL_REPRESENTATION))
+        {
+            it->setACLRepresentation(targetRepresentation);
+            updated = true;
+        }
+        if(it->contains(envelope::PAYLOAD_LENGTH))
+        {
+            it->setPayloadLength(payload.size());
+            updated = true;
+        }
+    }
+    if(updated)
+    {
+        letter.setExtraEnvelopes(extraEnvelopes);
+    }
+    return true;
+}
+
+} // end namespace acl
+} // end namespace fipa
@@ -0,0 +1,52 @@
+#ifndef FIPA_ACL_TRANSCODER_H
+#define FIPA_ACL_TRANSCODER_H
+
+#include <string>
+#include <fipa_acl/message_generator/acl_envelope.h>
+#include <fipa_acl/message_generator/types.h>
+
+namespace fipa {
+namespace acl {
+
+/**
+ * \class Transcoder
+ * \brief Convert encoded messages and the payload of letters between representations
+ * \details The source is decoded once and the target representation is written into the
+ * given output buffer. Data which already has the target representation is passed on without decoding.
+ *
+ * \verbatim
+ Letter letter;
+ EnvelopeParser::parseData(data, letter, representation::AUTO);
+ Transcoder::transcode(letter, representation::BITEFFICIENT);
+ \endverbatim
+ */
+class Transcoder
+{
+public:
+    /**
+     * Transcode an encoded message
+     * \param source Encoded message
+     * \param sourceRepresentation Representation of the source, or representation::AUTO to detect it
+     * \param target Output buffer for the encoded message in the target representation
+     * \param targetRepresentation Representation of the target
+     * \return true if the message has been transcoded, false if the source could not be decoded
+     * \throws std::runtime_error if there is no generator for the target representation
+     */
+    static bool transcode(const std::string& source, representation::Type sourceRepresentation,
+            std::string& target, representation::Type targetRepresentation);
+
+    /**
+     * Transcode the payload of a letter and update acl-representation and payload-length of
+     * the envelope, i.e. of the base envelope and of all extra envelopes which override them
+     * \param letter Letter to transcode
+     * \param targetRepresentation Representation of the payload after transcoding
+     * \return true if the payload has been transcoded, false if the payload could not be decoded
+     * \throws std::runtime_error if there is no generator for the target representation
+     */
+    static bool transcode(Letter& letter, representation::Type targetRepresentation);
+};
+
+} // end namespace acl
+} // end namespace fipa
+
+#endif // FIPA_ACL_TRANSCODER_H
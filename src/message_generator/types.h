@@ -23,9 +23,10 @@ namespace acl {
     namespace representation {
         // Naming of string with appendix, to avoid clashes where keyword 'string' 
         // cannot be handled properly, e.g. CORBA idl
-        enum Type { UNKNOWN, BITEFFICIENT, STRING_REP, XML, END_MARKER };
+        // AUTO is not a representation, but lets the parsers detect the representation of the data
+        enum Type { UNKNOWN, BITEFFICIENT, STRING_REP, XML, END_MARKER, AUTO };
 
-        const std::string TypeTxt[] = { "unknown", "fipa.acl.rep.bitefficient.std", "fipa.acl.rep.string.std", "fipa.acl.rep.xml.std"};
+        const std::string TypeTxt[] = { "unknown", "fipa.acl.rep.bitefficient.std", "fipa.acl.rep.string.std", "fipa.acl.rep.xml.std", "", "auto"};
     }
 
 } // end of acl
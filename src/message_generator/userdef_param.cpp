@@ -9,6 +9,7 @@
 
 #include "userdef_param.h"
 #include "acl_message.h"
+#include "word_validation.h"
 #include <stdexcept>
 
 namespace fipa {
@@ -44,7 +45,7 @@ bool UserdefParam::operator==(const UserdefParam& other) const
 
 void UserdefParam::setName(const std::string& name) 
 {
-    if ( (name.find_first_of(illegalWordChars) != std::string::npos) || (illegalWordStart.find_first_of(name.c_str()[0]) != std::string::npos) )
+    if (!word::isValid(name))
     {
         throw std::runtime_error("Illegal name for userdefined-parameter");
     }
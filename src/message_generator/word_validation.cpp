@@ -0,0 +1,64 @@
+#include "word_validation.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace fipa {
+namespace acl {
+namespace word {
+
+// Keep in sync with illegalWordChars and illegalWordStart
+static inline bool isIllegalChar(unsigned char c)
+{
+    return c == '(' || c == ')' || c == ' ' || c == 0x00;
+}
+
+static inline bool isIllegalStart(unsigned char c)
+{
+    return c == '@' || c == '#' || c == '-' || (c >= '0' && c <= '9');
+}
+
+size_t findIllegalChar(const char* data, size_t size)
+{
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i nul = _mm_setzero_si128();
+    // '(' and ')' only differ in the lowest bit
+    const __m128i lowestBit = _mm_set1_epi8(0x01);
+    const __m128i parenthesis = _mm_set1_epi8(')');
+    for(; i + 16 <= size; i += 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i matches = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, nul)),
+                _mm_cmpeq_epi8(_mm_or_si128(chunk, lowestBit), parenthesis));
+        int mask = _mm_movemask_epi8(matches);
+        if(mask != 0)
+        {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+    for(; i < size; ++i)
+    {
+        if(isIllegalChar(data[i]))
+        {
+            return i;
+        }
+    }
+    return size;
+}
+
+bool isValid(const std::string& text)
+{
+    if(text.empty())
+    {
+        return true;
+    }
+    return !isIllegalStart(text[0]) && findIllegalChar(text.data(), text.size()) == text.size();
+}
+
+} // end namespace word
+} // end namespace acl
+} // end namespace fipa
@@ -0,0 +1,30 @@
+#ifndef FIPA_ACL_WORD_VALIDATION_H
+#define FIPA_ACL_WORD_VALIDATION_H
+
+#include <string>
+
+namespace fipa {
+namespace acl {
+namespace word {
+
+/**
+ * Find the first character that must not be part of a word, i.e. one of illegalWordChars
+ * Uses SSE2 to test 16 characters at once, if available
+ * \param data Start of the character sequence
+ * \param size Number of characters
+ * \return index of the first illegal character, or size if there is none
+ */
+size_t findIllegalChar(const char* data, size_t size);
+
+/**
+ * Test whether the text is a valid word according to the fipa definition,
+ * i.e. does not contain any of illegalWordChars and does not start with one of illegalWordStart
+ * \return true if the text is a valid word, false otherwise
+ */
+bool isValid(const std::string& text);
+
+} // end namespace word
+} // end namespace acl
+} // end namespace fipa
+
+#endif // FIPA_ACL_WORD_VALIDATION_H
@@ -1,17 +1,35 @@
 #include "bitefficient_envelope_parser.h"
 #include "grammar/grammar_bitefficient_envelope.h"
+#include "parser_limits.h"
+#include <boost/thread/tss.hpp>
 
 namespace fipa {
 namespace acl {
         
+typedef fipa::acl::bitefficient::Envelope<std::string::const_iterator> bitefficient_envelope_grammar;
+
+// The grammar (and all its rules) is constructed only once per thread
+static boost::thread_specific_ptr<bitefficient_envelope_grammar> msGrammar;
+
+static bitefficient_envelope_grammar* getGrammar()
+{
+    bitefficient_envelope_grammar* grammar = msGrammar.get();
+    if(!grammar)
+    {
+        grammar = new bitefficient_envelope_grammar();
+        msGrammar.reset(grammar);
+    }
+    grammar->setMaxResolverDepth(ParserLimits::getDefault().getMaxResolverDepth());
+    return grammar;
+}
+
 bool BitefficientEnvelopeParser::parseData(const std::string& storage, ACLEnvelope& envelope)
 {
-    typedef fipa::acl::bitefficient::Envelope<std::string::const_iterator> bitefficient_envelope_grammar;
-    bitefficient_envelope_grammar grammar;
+    bitefficient_envelope_grammar* grammar = getGrammar();
 
     std::string::const_iterator iter = storage.begin(); 
     std::string::const_iterator end = storage.end(); 
-    bool r = parse(iter, end, grammar, envelope);
+    bool r = parse(iter, end, *grammar, envelope);
 
     if(r && iter == end)
     {
@@ -20,5 +38,18 @@ bool BitefficientEnvelopeParser::parseData(const std::string& storage, ACLEnvelo
     return false;
 }
 
+bool BitefficientEnvelopeParser::parseEnvelopes(std::string::const_iterator begin, std::string::const_iterator end, ACLEnvelope& envelope, std::string::const_iterator& payloadBegin)
+{
+    bitefficient_envelope_grammar* grammar = getGrammar();
+
+    std::string::const_iterator iter = begin;
+    if(parse(iter, end, grammar->envelopes_rule, envelope))
+    {
+        payloadBegin = iter;
+        return true;
+    }
+    return false;
+}
+
 } // end namespace acl
 } // end namespace fipa
@@ -14,6 +14,16 @@ class BitefficientEnvelopeParser : public EnvelopeParserImplementation
 
 public: 
     bool parseData(const std::string& storage, ACLEnvelope& envelope);
+
+    /**
+     * Parse only the envelopes at the start of a letter, i.e. without the payload
+     * \param begin Start of the letter
+     * \param end End of the available data
+     * \param envelope Parsed envelope (without payload)
+     * \param payloadBegin Set to the start of the payload on success
+     * \return true if complete envelopes have been found, false otherwise
+     */
+    static bool parseEnvelopes(std::string::const_iterator begin, std::string::const_iterator end, ACLEnvelope& envelope, std::string::const_iterator& payloadBegin);
 };
 
 } // end namespace acl
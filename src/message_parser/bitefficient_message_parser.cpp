@@ -8,28 +8,66 @@
 #include <boost/variant/get.hpp>
 #include <boost/variant/recursive_variant.hpp>
 #include <boost/variant/variant.hpp>
+#include <boost/thread/tss.hpp>
 #include <base/logging.h>
 
 #include "bitefficient_message_parser.h"
 #include "grammar/grammar_bitefficient.h"
+#include "parser_limits.h"
 
 
 namespace fipa { 
 namespace acl {
 
-bool BitefficientMessageParser::parseData(const std::string& storage, ACLMessage &msg)
+typedef fipa::acl::bitefficient::Message<std::string::const_iterator> bitefficient_message_grammar;
+
+/**
+ * Per-thread parsing state which is reused between messages:
+ * the grammar (and all its rules) is constructed only once per thread, and the
+ * parse tree keeps its allocated capacity
+ */
+struct BitefficientMessageParseContext
 {
-    typedef fipa::acl::bitefficient::Message<std::string::const_iterator> bitefficient_message_grammar;
     bitefficient_message_grammar grammar;
     fipa::acl::Message parseTree;
 
+    /**
+     * Reset the parse tree before parsing the next message
+     */
+    void reset()
+    {
+        parseTree.type.clear();
+        parseTree.parameters.clear();
+    }
+};
+
+static boost::thread_specific_ptr<BitefficientMessageParseContext> msParseContext;
+
+bool BitefficientMessageParser::parseData(const std::string& storage, ACLMessage &msg)
+{
+    BitefficientMessageParseContext* context = msParseContext.get();
+    if(!context)
+    {
+        context = new BitefficientMessageParseContext();
+        msParseContext.reset(context);
+    }
+    context->reset();
+    context->grammar.setMaxResolverDepth(ParserLimits::getDefault().getMaxResolverDepth());
+
     std::string::const_iterator iter = storage.begin();
     std::string::const_iterator end = storage.end();
-    bool r = parse(iter, end, grammar, parseTree);
+    bool r = parse(iter, end, context->grammar, context->parseTree);
     
     if(r && iter == end)
     {
-    	return buildMessage(parseTree, msg);
+        try {
+            return buildMessage(context->parseTree, msg);
+        } catch(const std::exception& e)
+        {
+            // Parsed values which are invalid for the message, e.g. illegal characters in a word
+            LOG_ERROR("Failed to build message from parsed data: %s", e.what());
+            return false;
+        }
     }
     
     return false;
@@ -50,9 +88,7 @@ void BitefficientMessageParser::buildParameters(const std::vector<message::Param
  
     for (; it != parsedParams.end(); ++it)
     {	
-        try {
-            buildPredefMessageParameters(*it,msg);
-        } catch(const std::runtime_error& e)
+        if(!buildPredefMessageParameters(*it,msg))
         {
 	    UserdefParam param = buildUserdefParameter(*it);
             LOG_INFO("Creating userdefined parameter name: '%s' value: '%s'", param.getName().c_str(), param.getValue().c_str());
@@ -61,33 +97,33 @@ void BitefficientMessageParser::buildParameters(const std::vector<message::Param
     }
 }
 
-void BitefficientMessageParser::buildPredefMessageParameters(const message::Parameter& param, ACLMessage &msg)
+bool BitefficientMessageParser::buildPredefMessageParameters(const message::Parameter& param, ACLMessage &msg)
 {
     // Parameter that require custom conversion from internal data types
     if (param.name == "sender") 
     {
         buildSender(param, msg);
-        return;
+        return true;
     } 
     if (param.name == "receiver") 
     {
         buildReceiver(param, msg);
-        return;
+        return true;
     }
     if (param.name == "content") 
     {
         buildContent(param, msg);
-        return;
+        return true;
     } 
     if (param.name == "reply-by") 
     {
         buildReplyBy(param, msg);
-        return;
+        return true;
     } 
     if (param.name == "reply-to") 
     {
         buildReplyTo(param, msg);
-        return;
+        return true;
     } 
    
     // Parameters that use string data type
@@ -103,43 +139,42 @@ void BitefficientMessageParser::buildPredefMessageParameters(const message::Para
     if (param.name == "in-reply-to") 
     {
         msg.setInReplyTo(value);
-        return;
+        return true;
     } 
     if (param.name == "reply-with") 
     {
         msg.setReplyWith(value);
-        return;
+        return true;
     } 
     if (param.name == "language")
     {
         msg.setLanguage(value);
-        return;
+        return true;
     } 
     if (param.name == "encoding") 
     {
         msg.setEncoding(value);
-        return;
+        return true;
     } 
     if (param.name == "ontology") 
     {
         msg.setOntology(value);
-        return;
+        return true;
     } 
     if (param.name == "protocol") 
     {
         msg.setProtocol(value);
-        return;
+        return true;
     } 
     
     if (param.name == "conversation-id") 
     {
         msg.setConversationID(value);
-        return;
+        return true;
     }
 
-    std::string errorMsg = "Message parameter '" + param.name + "' is not predefined";
-    LOG_ERROR("%s",errorMsg.c_str());
-    throw std::runtime_error(errorMsg);
+    LOG_DEBUG("Message parameter '%s' is not predefined", param.name.c_str());
+    return false;
 }
 
 void BitefficientMessageParser::buildSender(const message::Parameter& param, ACLMessage &msg)
@@ -257,9 +292,14 @@ void BitefficientMessageParser::buildReplyTo(const message::Parameter& param, AC
 void BitefficientMessageParser::buildContent(const message::Parameter& param,ACLMessage &msg)
 {
     const ByteSequence& byteSequence = boost::get<ByteSequence>(param.data);
-    std::string content;
-    byteSequence.toRawDataString(&content);
-    msg.setContent(content);
+    // Set the content directly from the parsed bytes to avoid a temporary copy
+    const std::vector<unsigned char>* bytes = boost::get<std::vector<unsigned char> >(&byteSequence.bytes);
+    if(bytes)
+    {
+        msg.setContent(bytes->empty() ? "" : reinterpret_cast<const char*>(&(*bytes)[0]), bytes->size());
+    } else {
+        msg.setContent(boost::get<std::string>(byteSequence.bytes));
+    }
 }
 
 }}
@@ -73,9 +73,9 @@ class BitefficientMessageParser : public MessageParserImplementation
 
                 /**
                  * Build predefined message parameters
-                 * \throw std::runtime_error if message parameter is unknown
+                 * \return false if message parameter is not predefined, true otherwise
                  */
-		void buildPredefMessageParameters(const message::Parameter& param, ACLMessage &msg);
+		bool buildPredefMessageParameters(const message::Parameter& param, ACLMessage &msg);
 
                 /**
                  * Build sender from message parameter
@@ -165,6 +165,17 @@ struct ByteSequence
 		// Since bytes is a variant we apply the visitor pattern here
 		boost::apply_visitor( ByteStringRawPrinter(output), bytes);
 	}
+
+        /**
+         * Exchange the data with another byte sequence without
+         * copying the bytes
+         */
+	void swap(ByteSequence& other)
+	{
+		encoding.swap(other.encoding);
+		length.swap(other.length);
+		bytes.swap(other.bytes);
+	}
 };
 
 
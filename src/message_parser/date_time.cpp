@@ -1,5 +1,8 @@
 #include "date_time.h"
 #include <base/logging.h>
+#include <string.h>
+#include <stdexcept>
+#include <boost/atomic.hpp>
 
 namespace fipa {
 namespace acl {
@@ -27,12 +30,336 @@ std::string DateTime::toString() const
 
 base::Time DateTime::toTime() const
 {
-    // Tell make to check whether daylight saving is in effect
+    return fromLocalTime(dateTime);
+}
+
+const size_t DateTime::BIN_DATE_SIZE;
+
+/**
+ * Cache for the offset to UTC of a 15 minute slot
+ * Slot and offset are packed into a single atomic value, so that lookups
+ * are lock free
+ */
+class UTCOffsetCache
+{
+public:
+    UTCOffsetCache() : mEntry(0) {}
+
+    bool get(int64_t slot, int32_t& offset) const
+    {
+        uint64_t entry = mEntry.load(boost::memory_order_relaxed);
+        if(entry == 0 || static_cast<int64_t>(entry >> 24) - SLOT_BIAS != slot)
+        {
+            return false;
+        }
+        offset = static_cast<int32_t>(entry & 0xffffff) - OFFSET_BIAS;
+        return true;
+    }
+
+    void set(int64_t slot, int32_t offset)
+    {
+        uint64_t entry = (static_cast<uint64_t>(slot + SLOT_BIAS) << 24) | static_cast<uint64_t>(offset + OFFSET_BIAS);
+        mEntry.store(entry, boost::memory_order_relaxed);
+    }
+
+    void clear() { mEntry.store(0, boost::memory_order_relaxed); }
+
+private:
+    static const int64_t SLOT_BIAS = 1LL << 39;
+    static const int32_t OFFSET_BIAS = 1 << 23;
+
+    boost::atomic<uint64_t> mEntry;
+};
+
+// Offset to UTC per 15 minute slot of the UTC time
+static UTCOffsetCache utcSlotOffsets;
+// Offset to UTC per 15 minute slot of the local time
+static UTCOffsetCache localSlotOffsets;
+
+static const int64_t SECONDS_PER_DAY = 86400;
+static const int64_t SECONDS_PER_SLOT = 900;
+
+static int64_t floorDiv(int64_t a, int64_t b)
+{
+    int64_t q = a / b;
+    if((a % b != 0) && ((a < 0) != (b < 0)))
+    {
+        --q;
+    }
+    return q;
+}
+
+/**
+ * Days since 1970-01-01 of the given date of the proleptic gregorian calendar
+ * (month in [1,12])
+ */
+static int64_t daysFromCivil(int64_t year, int month, int day)
+{
+    year -= month <= 2;
+    int64_t era = floorDiv(year, 400);
+    int64_t yearOfEra = year - era*400;
+    int64_t dayOfYear = (153*(month + (month > 2 ? -3 : 9)) + 2)/5 + day - 1;
+    int64_t dayOfEra = yearOfEra*365 + yearOfEra/4 - yearOfEra/100 + dayOfYear;
+    return era*146097 + dayOfEra - 719468;
+}
+
+/**
+ * Date of the proleptic gregorian calendar for days since 1970-01-01
+ */
+static void civilFromDays(int64_t days, int64_t& year, int& month, int& day)
+{
+    days += 719468;
+    int64_t era = floorDiv(days, 146097);
+    int64_t dayOfEra = days - era*146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra/1460 + dayOfEra/36524 - dayOfEra/146096)/365;
+    int64_t dayOfYear = dayOfEra - (365*yearOfEra + yearOfEra/4 - yearOfEra/100);
+    int64_t mp = (5*dayOfYear + 2)/153;
+    day = static_cast<int>(dayOfYear - (153*mp + 2)/5 + 1);
+    month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    year = yearOfEra + era*400 + (month <= 2);
+}
+
+static bool isLeapYear(int64_t year)
+{
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+static int daysInMonth(int64_t year, int month)
+{
+    static const int days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    if(month == 2 && isLeapYear(year))
+    {
+        return 29;
+    }
+    return days[month - 1];
+}
+
+/**
+ * Offset of local time to UTC for the given UTC time in seconds
+ */
+static int32_t getUTCOffsetForUTC(int64_t utcSeconds)
+{
+    int64_t slot = floorDiv(utcSeconds, SECONDS_PER_SLOT);
+    int32_t offset;
+    if(utcSlotOffsets.get(slot, offset))
+    {
+        return offset;
+    }
+
+    time_t when = static_cast<time_t>(utcSeconds);
+    struct tm tm;
+    if(localtime_r(&when, &tm) == NULL)
+    {
+        throw std::runtime_error("DateTime: cannot convert time to local time");
+    }
+    offset = static_cast<int32_t>(tm.tm_gmtoff);
+    utcSlotOffsets.set(slot, offset);
+    return offset;
+}
+
+/**
+ * Offset of local time to UTC for the given local time in seconds
+ * (seconds since 1970-01-01 as if the local time was UTC)
+ */
+static int32_t getUTCOffsetForLocal(int64_t localSeconds)
+{
+    int64_t slot = floorDiv(localSeconds, SECONDS_PER_SLOT);
+    int32_t offset;
+    if(localSlotOffsets.get(slot, offset))
+    {
+        return offset;
+    }
+
+    // Let mktime check whether daylight saving is in effect
     // http://pubs.opengroup.org/onlinepubs/007904975/functions/strptime.html
-    Time timeTmp = dateTime;
-    timeTmp.tm_isdst = -1;
-    time_t time = mktime(dynamic_cast<std::tm*>(&timeTmp));
-    return base::Time::fromMilliseconds(time*static_cast<uint64_t>(base::Time::Milliseconds) + timeTmp.tm_msec);
+    int64_t year;
+    int month, day;
+    int64_t days = floorDiv(localSeconds, SECONDS_PER_DAY);
+    int64_t secondOfDay = localSeconds - days*SECONDS_PER_DAY;
+    civilFromDays(days, year, month, day);
+
+    struct tm tm;
+    memset(&tm, 0, sizeof(tm));
+    tm.tm_year = static_cast<int>(year - 1900);
+    tm.tm_mon = month - 1;
+    tm.tm_mday = day;
+    tm.tm_hour = static_cast<int>(secondOfDay / 3600);
+    tm.tm_min = static_cast<int>((secondOfDay % 3600) / 60);
+    tm.tm_sec = static_cast<int>(secondOfDay % 60);
+    tm.tm_isdst = -1;
+    time_t utcSeconds = mktime(&tm);
+
+    offset = static_cast<int32_t>(localSeconds - utcSeconds);
+    localSlotOffsets.set(slot, offset);
+    return offset;
+}
+
+base::Time DateTime::fromLocalTime(const Time& time)
+{
+    int64_t year = static_cast<int64_t>(time.tm_year) + 1900;
+    int month = time.tm_mon + 1;
+    if(month < 1 || month > 12)
+    {
+        // Not normalized, leave it to the C library
+        Time timeTmp = time;
+        timeTmp.tm_isdst = -1;
+        time_t seconds = mktime(&timeTmp);
+        return base::Time::fromMicroseconds(static_cast<int64_t>(seconds)*1000000 + static_cast<int64_t>(timeTmp.tm_msec)*1000);
+    }
+
+    int64_t localSeconds = daysFromCivil(year, month, time.tm_mday)*SECONDS_PER_DAY
+        + time.tm_hour*3600 + time.tm_min*60 + time.tm_sec;
+    int64_t utcSeconds = localSeconds - getUTCOffsetForLocal(localSeconds);
+    return base::Time::fromMicroseconds(utcSeconds*1000000 + static_cast<int64_t>(time.tm_msec)*1000);
+}
+
+void DateTime::toLocalTime(const base::Time& time, Time& localTime)
+{
+    int64_t usecs = time.toMicroseconds();
+    int64_t utcSeconds = floorDiv(usecs, 1000000);
+    int msecs = static_cast<int>((usecs - utcSeconds*1000000) / 1000);
+
+    int64_t localSeconds = utcSeconds + getUTCOffsetForUTC(utcSeconds);
+    int64_t days = floorDiv(localSeconds, SECONDS_PER_DAY);
+    int64_t secondOfDay = localSeconds - days*SECONDS_PER_DAY;
+
+    int64_t year;
+    int month, day;
+    civilFromDays(days, year, month, day);
+
+    memset(&localTime, 0, sizeof(Time));
+    localTime.tm_year = static_cast<int>(year - 1900);
+    localTime.tm_mon = month - 1;
+    localTime.tm_mday = day;
+    localTime.tm_hour = static_cast<int>(secondOfDay / 3600);
+    localTime.tm_min = static_cast<int>((secondOfDay % 3600) / 60);
+    localTime.tm_sec = static_cast<int>(secondOfDay % 60);
+    localTime.tm_msec = msecs;
+    localTime.tm_isdst = -1;
+}
+
+void DateTime::resetUTCOffsetCache()
+{
+    utcSlotOffsets.clear();
+    localSlotOffsets.clear();
+}
+
+/**
+ * Encode a number in [0,99] as byte of two coded digits (digit + 1 per nibble)
+ */
+static char encodeCodedDigitPair(int number)
+{
+    return char((((number / 10) + 1) << 4) | ((number % 10) + 1));
+}
+
+/**
+ * Decode a byte holding two coded digits (digit + 1 per nibble)
+ * \return value in [0,99] or -1 if not a coded digit pair
+ */
+static int decodeCodedDigitPair(unsigned char code)
+{
+    int high = (code >> 4) - 1;
+    int low = (code & 0x0f) - 1;
+    if(high < 0 || high > 9 || low < 0 || low > 9)
+    {
+        return -1;
+    }
+    return high*10 + low;
+}
+
+void DateTime::encodeBinDate(const base::Time& time, char* data)
+{
+    Time localTime;
+    toLocalTime(time, localTime);
+
+    int year = localTime.tm_year + 1900;
+    if(year < 0 || year > 9999)
+    {
+        throw std::runtime_error("DateTime: year out of range for bitefficient date");
+    }
+
+    data[0] = encodeCodedDigitPair(year / 100);
+    data[1] = encodeCodedDigitPair(year % 100);
+    data[2] = encodeCodedDigitPair(localTime.tm_mon + 1);
+    data[3] = encodeCodedDigitPair(localTime.tm_mday);
+    data[4] = encodeCodedDigitPair(localTime.tm_hour);
+    data[5] = encodeCodedDigitPair(localTime.tm_min);
+    data[6] = encodeCodedDigitPair(localTime.tm_sec);
+    // millisecond field is extended to 4 digits: 0mmm
+    data[7] = encodeCodedDigitPair(localTime.tm_msec / 100);
+    data[8] = encodeCodedDigitPair(localTime.tm_msec % 100);
+}
+
+/**
+ * Decode and validate the fields of a bitefficient date
+ * \param fields year, month, day, hour, minute, second, millisecond
+ * \return false if the data is too short, contains other than coded digits or a field is out of range
+ */
+static bool decodeBinDateFields(const unsigned char* data, size_t size, int fields[7])
+{
+    if(size < DateTime::BIN_DATE_SIZE)
+    {
+        return false;
+    }
+
+    int values[DateTime::BIN_DATE_SIZE];
+    for(size_t i = 0; i < DateTime::BIN_DATE_SIZE; ++i)
+    {
+        values[i] = decodeCodedDigitPair(data[i]);
+        if(values[i] < 0)
+        {
+            return false;
+        }
+    }
+
+    fields[0] = values[0]*100 + values[1];
+    fields[1] = values[2];
+    fields[2] = values[3];
+    fields[3] = values[4];
+    fields[4] = values[5];
+    fields[5] = values[6];
+    fields[6] = values[7]*100 + values[8];
+
+    return fields[1] >= 1 && fields[1] <= 12
+        && fields[2] >= 1 && fields[2] <= daysInMonth(fields[0], fields[1])
+        && fields[3] <= 23 && fields[4] <= 59 && fields[5] <= 59
+        // leading digit of the 4 digit millisecond field has to be 0
+        && values[7] <= 9;
+}
+
+bool DateTime::decodeBinDate(const unsigned char* data, size_t size, Time& time)
+{
+    int fields[7];
+    if(!decodeBinDateFields(data, size, fields))
+    {
+        return false;
+    }
+
+    memset(&time, 0, sizeof(Time));
+    time.tm_year = fields[0] - 1900;
+    time.tm_mon = fields[1] - 1;
+    time.tm_mday = fields[2];
+    time.tm_hour = fields[3];
+    time.tm_min = fields[4];
+    time.tm_sec = fields[5];
+    time.tm_msec = fields[6];
+    time.tm_isdst = -1;
+    return true;
+}
+
+bool DateTime::decodeBinDate(const unsigned char* data, size_t size, base::Time& time)
+{
+    int fields[7];
+    if(!decodeBinDateFields(data, size, fields))
+    {
+        return false;
+    }
+
+    int64_t localSeconds = daysFromCivil(fields[0], fields[1], fields[2])*SECONDS_PER_DAY
+        + fields[3]*3600 + fields[4]*60 + fields[5];
+    int64_t utcSeconds = localSeconds - getUTCOffsetForLocal(localSeconds);
+    time = base::Time::fromMicroseconds(utcSeconds*1000000 + static_cast<int64_t>(fields[6])*1000);
+    return true;
 }
 
 }
@@ -37,6 +37,55 @@ struct DateTime
      * \return base time
      */
     base::Time toTime() const;
+
+    /**
+     * Size of the bitefficient date, i.e. 18 coded digits YYYYMMDDhhmmss0mmm
+     */
+    static const size_t BIN_DATE_SIZE = 9;
+
+    /**
+     * Encode time as bitefficient date (local time), i.e. coded digit pairs YYYYMMDDhhmmss0mmm,
+     * computed arithmetically without formatting a string
+     * \param time time to encode, sub-millisecond fractions are truncated
+     * \param data buffer holding at least BIN_DATE_SIZE bytes
+     */
+    static void encodeBinDate(const base::Time& time, char* data);
+
+    /**
+     * Decode the bitefficient date, i.e. coded digit pairs YYYYMMDDhhmmss0mmm,
+     * arithmetically into time
+     * \param data encoded date
+     * \param size number of bytes available, at least BIN_DATE_SIZE are required
+     * \param time decoded time
+     * \return false if the data is too short, contains other than coded digits or
+     * a field is out of range
+     */
+    static bool decodeBinDate(const unsigned char* data, size_t size, Time& time);
+
+    /**
+     * Decode the bitefficient date directly into base time, i.e. without going through std::tm
+     * \see decodeBinDate(const unsigned char*, size_t, Time&)
+     */
+    static bool decodeBinDate(const unsigned char* data, size_t size, base::Time& time);
+
+    /**
+     * Convert broken down local time to base time
+     * The offset to UTC is computed by the C library only once per
+     * 15 minute slot and cached afterwards
+     */
+    static base::Time fromLocalTime(const Time& time);
+
+    /**
+     * Convert base time to broken down local time (including milliseconds)
+     * \see fromLocalTime
+     */
+    static void toLocalTime(const base::Time& time, Time& localTime);
+
+    /**
+     * Clear the cached offsets to UTC, required when the timezone
+     * of the process has been changed after dates have been converted
+     */
+    static void resetUTCOffsetCache();
 }; 
 
 
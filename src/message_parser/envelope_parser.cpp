@@ -1,8 +1,11 @@
 #include "envelope_parser.h"
 #include "bitefficient_envelope_parser.h"
 #include "xml_envelope_parser.h"
+#include "parser_limits.h"
+#include "representation_detector.h"
 
 #include <boost/assign/list_of.hpp>
+#include <base/logging.h>
 
 namespace fipa {
 namespace acl {
@@ -14,10 +17,39 @@ std::map<representation::Type, EnvelopeParserImplementationPtr > EnvelopeParser:
 
 bool EnvelopeParser::parseData(const std::string& storage, ACLEnvelope& envelope, representation::Type type)
 {
+    if(type == representation::AUTO)
+    {
+        type = RepresentationDetector::detectEnvelope(storage);
+        if(type == representation::UNKNOWN)
+        {
+            LOG_WARN("EnvelopeParser: could not detect the representation of the letter");
+            return false;
+        }
+    }
+
     EnvelopeParserImplementationPtr messageParser = msParsers[type];
     if(messageParser)
     {
-        return messageParser->parseData(storage, envelope);
+        ParserLimits limits = ParserLimits::getDefault();
+        if(limits.exceedsMessageSize(storage.size()))
+        {
+            LOG_WARN("EnvelopeParser: rejecting letter of %lu bytes, maximum is %lu", storage.size(), limits.getMaxMessageSize());
+            return false;
+        }
+
+        if(!messageParser->parseData(storage, envelope))
+        {
+            return false;
+        }
+
+        try {
+            limits.validate(envelope);
+        } catch(const std::runtime_error& e)
+        {
+            LOG_WARN("EnvelopeParser: rejecting letter: %s", e.what());
+            return false;
+        }
+        return true;
     } else {
         std::string msg = "EnvelopeParser: there is no parser registered for " + representation::TypeTxt[type];
         throw std::runtime_error(msg);
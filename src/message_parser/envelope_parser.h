@@ -22,6 +22,14 @@ class EnvelopeParser
 {
 
 public: 
+    /**
+     * Parse an encoded letter
+     * \param storage Encoded envelope and payload
+     * \param envelope The decoded letter
+     * \param type Representation of the envelope, or representation::AUTO to detect the representation from the
+     * data, see RepresentationDetector
+     * \return true if the letter has been decoded, false otherwise
+     */
     static bool parseData(const std::string& storage, ACLEnvelope& envelope, representation::Type type  = fipa::acl::representation::BITEFFICIENT);
 
 private:
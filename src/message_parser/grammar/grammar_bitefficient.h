@@ -81,17 +81,15 @@ struct BinStringNoCodetable : qi::grammar<Iterator, fipa::acl::ByteSequence(), q
         using namespace qi;
 
         bin_string_no_codetable_rule = ( byte_(0x14) >> nullTerminatedString 	[ label::_val = label::_1 ])
-            // The byte length will be stored in the rule local variable (label::_a) and then forwarded to the qi::repeat instruction
+            // The byte length will be stored in the rule local variable (label::_a) and then forwarded to the byte_block parser
             | ( byte_(0x16) >> len8                       	[ label::_a = label::_1 ]
-                  	  >> byteSeq(label::_a)			[ phoenix::at_c<2>(label::_val) = label::_1] )  // new byteLengthEncoded string 
+                  	  >> byte_block(label::_a)		[ swapIntoByteString(phoenix::at_c<2>(label::_val), label::_1) ] )  // new byteLengthEncoded string 
             | ( byte_(0x17) >> len16 			        [ label::_a = label::_1 ]
-                            >> byteSeq(label::_a)			[ phoenix::at_c<2>(label::_val) = label::_1 ] )
+                            >> byte_block(label::_a)		[ swapIntoByteString(phoenix::at_c<2>(label::_val), label::_1) ] )
             | ( byte_(0x19) >> len32 			        [ label::_a = label::_1 ]
-                            >> byteSeq(label::_a)			[ phoenix::at_c<2>(label::_val) = label::_1 ] )
+                            >> byte_block(label::_a)		[ swapIntoByteString(phoenix::at_c<2>(label::_val), label::_1) ] )
             ;         
 
-	byteSeq = qi::repeat(label::_r1)[byte_]	[ label::_val = convertToCharVector(label::_1) ]
-		;
 	FIPA_DEBUG_RULE(bin_string_no_codetable_rule);
     }
 
@@ -99,7 +97,6 @@ struct BinStringNoCodetable : qi::grammar<Iterator, fipa::acl::ByteSequence(), q
     Len8<Iterator> len8;
     Len16<Iterator> len16;
     Len32<Iterator> len32;
-    qi::rule<Iterator, std::vector<unsigned char>(boost::uint_least32_t) > byteSeq;
     NullTerminatedString<Iterator> nullTerminatedString;
 };
 
@@ -129,7 +126,7 @@ struct BinString : qi::grammar<Iterator, fipa::acl::ByteSequence() >
 {
     BinString() : BinString::base_type(bin_string_rule, "BinString-bitefficient_grammar")
     {
-        bin_string_rule = ( binStringNoCodetable | binStringCodetable) [ label::_val = label::_1];
+        bin_string_rule %= binStringNoCodetable | binStringCodetable;
 
 	FIPA_DEBUG_RULE(bin_string_rule);
     }
@@ -318,7 +315,7 @@ struct BinExpression : qi::grammar<Iterator, std::string()>
 	// Digits tell the byte encoding
 	// label::_r1 is an inherited local variable from the parent rule
 	byteLengthEncodedString = byteLengthEncodedStringHeader 		        [ phoenix::at_c<0>(label::_val) += label::_1 ]
-				>> qi::repeat(label::_r1)[byte_]     			[ phoenix::at_c<2>(label::_val) = convertToString(label::_1) ]
+				>> byte_block(label::_r1)     			[ phoenix::at_c<2>(label::_val) = convertToString(label::_1) ]
 				;
 
     #ifdef BOOST_SPIRIT_DEBUG
@@ -381,17 +378,22 @@ template<typename Iterator>
 struct AgentIdentifier : qi::grammar<Iterator, fipa::acl::AgentIdentifier()>
 {
     AgentIdentifier() : AgentIdentifier::base_type(agent_identifier_rule, "AgentIdentifier-bitefficient_grammar")
+        , maxResolverDepth(0)
     {
         using qi::byte_;
 
-        agent_identifier_rule = byte_(0x02) >> agentName 		[ phoenix::at_c<0>(label::_val) = label::_1 ]
+        agent_identifier_rule %= nested_agent_identifier_rule(0u);
+
+        // label::_r1 is the nesting depth of the agent identifier, which is limited for resolvers
+        nested_agent_identifier_rule = byte_(0x02) >> agentName 		[ phoenix::at_c<0>(label::_val) = label::_1 ]
        		 >> -addresses  	   		[ phoenix::at_c<1>(label::_val) = label::_1 ]
-       		 >> -resolvers 	           		[ phoenix::at_c<2>(label::_val) = label::_1 ]
+       		 >> -resolvers(label::_r1)	           		[ phoenix::at_c<2>(label::_val) = label::_1 ]
        		 >> *userDefinedParameter		[ phoenix::push_back(phoenix::at_c<3>(label::_val), label::_1) ] 
        		 >> endOfCollection;				
         
         addresses = byte_(0x02) >> urlCollection 		[ label::_val = label::_1 ];
-        resolvers = byte_(0x03) >> *agent_identifier_rule       [ phoenix::push_back(label::_val, label::_1) ]
+        resolvers = byte_(0x03) >> qi::eps( phoenix::cref(maxResolverDepth) == 0u || label::_r1 < phoenix::cref(maxResolverDepth) )
+                           >> *nested_agent_identifier_rule(label::_r1 + 1u)       [ phoenix::push_back(label::_val, label::_1) ]
        			   >> endOfCollection;
         
         urlCollection = *url 					[ phoenix::push_back(label::_val, label::_1) ]
@@ -405,14 +407,22 @@ struct AgentIdentifier : qi::grammar<Iterator, fipa::acl::AgentIdentifier()>
 	FIPA_DEBUG_RULE(agent_identifier_rule);
     }
 
+    /**
+     * Set the maximum nesting depth of resolvers, 0 for no limit
+     * \see ParserLimits
+     */
+    void setMaxResolverDepth(size_t depth) { maxResolverDepth = depth; }
+
     qi::rule<Iterator, fipa::acl::AgentIdentifier()> agent_identifier_rule;
+    qi::rule<Iterator, fipa::acl::AgentIdentifier(boost::uint32_t)> nested_agent_identifier_rule;
     BinWord<Iterator> agentName;
     qi::rule<Iterator, std::vector<std::string>() > addresses;
-    qi::rule<Iterator, std::vector<fipa::acl::Resolver>() > resolvers;
+    qi::rule<Iterator, std::vector<fipa::acl::Resolver>(boost::uint32_t) > resolvers;
     UserdefinedParameter<Iterator> userDefinedParameter;
     qi::rule<Iterator, std::vector<std::string>() > urlCollection;
     BinWord<Iterator> url;
     qi::rule<Iterator> endOfCollection;
+    size_t maxResolverDepth;
 };
 
 template <typename Iterator>
@@ -440,7 +450,7 @@ struct Message : qi::grammar<Iterator, fipa::acl::Message()>
 		// defined with the BOOST_FUSION_ADAPT_STRUCT definition
 		aclCommunicativeAct = header          		 [ phoenix::at_c<0>(label::_val) = label::_1 ]
 				      >> messageType		 [ phoenix::at_c<1>(label::_val) = label::_1 ]
-				      >> *messageParameter       [ phoenix::push_back(phoenix::at_c<2>(label::_val), label::_1) ]
+				      >> *messageParameter       [ pushBackSwapped(phoenix::at_c<2>(label::_val), label::_1) ]
 				      >> endOfMessage           // No action here
 				     ;
 
@@ -507,7 +517,7 @@ struct Message : qi::grammar<Iterator, fipa::acl::Message()>
 		// predefinedMessageParameter uses a boost::variant
 		predefinedMessageParameter = byte_(0x02) [ phoenix::at_c<0>(label::_val) = "sender" ]       >> agentIdentifier [ phoenix::at_c<1>(label::_val) = label::_1 ]    // sender
 					| byte_(0x03) [ phoenix::at_c<0>(label::_val) = "receiver" ]        >> recipientExpr   [ phoenix::at_c<1>(label::_val) = label::_1 ]   // receiver 
-					| byte_(0x04) [ phoenix::at_c<0>(label::_val) = "content" ]         >> msgContent      [ phoenix::at_c<1>(label::_val) = label::_1 ]   // content 
+					| byte_(0x04) [ phoenix::at_c<0>(label::_val) = "content" ]         >> msgContent      [ swapIntoVariant(phoenix::at_c<1>(label::_val), label::_1) ]   // content 
 					| byte_(0x05) [ phoenix::at_c<0>(label::_val) = "reply-with" ]      >> replyWithParam  [ phoenix::at_c<1>(label::_val) = label::_1 ]   // reply-with
 					| byte_(0x06) [ phoenix::at_c<0>(label::_val) = "reply-by" ]        >> replyByParam    [ phoenix::at_c<1>(label::_val) = label::_1 ]  // reply-by 
 					| byte_(0x07) [ phoenix::at_c<0>(label::_val) = "in-reply-to" ]     >> inReplyToParam  [ phoenix::at_c<1>(label::_val) = label::_1 ]  // in-reply-to 
@@ -542,6 +552,12 @@ struct Message : qi::grammar<Iterator, fipa::acl::Message()>
 	#endif
 		
 	}
+
+	/**
+	 * Set the maximum nesting depth of resolvers in agent identifiers, 0 for no limit
+	 * \see ParserLimits
+	 */
+	void setMaxResolverDepth(size_t depth) { agentIdentifier.setMaxResolverDepth(depth); }
 	
 	// Define rules as follows
 	// qi::rule<Iterator, synthesized_attribute(inherited_attribute>)> r;
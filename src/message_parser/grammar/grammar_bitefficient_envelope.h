@@ -99,17 +99,22 @@ template<typename Iterator>
 struct EnvelopeAgentIdentifier : qi::grammar<Iterator, fipa::acl::AgentID()>
 {
     EnvelopeAgentIdentifier() : EnvelopeAgentIdentifier::base_type(agent_identifier_rule, "EnvelopeAgentIdentifier-bitefficient_grammar")
+        , maxResolverDepth(0)
     {
         using qi::byte_;
 
-        agent_identifier_rule = byte_(0x02) >> agentName 		[ phoenix::at_c<0>(label::_val) = convertToString(label::_1) ]
+        agent_identifier_rule %= nested_agent_identifier_rule(0u);
+
+        // label::_r1 is the nesting depth of the agent identifier, which is limited for resolvers
+        nested_agent_identifier_rule = byte_(0x02) >> agentName 		[ phoenix::at_c<0>(label::_val) = convertToString(label::_1) ]
      		 >> -addresses  	   		[ phoenix::at_c<1>(label::_val) = label::_1 ]
-     		 >> -resolvers 	           		[ phoenix::at_c<2>(label::_val) = label::_1 ]
+     		 >> -resolvers(label::_r1)	           		[ phoenix::at_c<2>(label::_val) = label::_1 ]
      		 >> -userDefinedParameters		[ phoenix::at_c<3>(label::_val) = label::_1 ]
      		 >> endOfCollection;
 
         addresses = byte_(0x02) >> urlCollection 		[ label::_val = label::_1 ];
-        resolvers = byte_(0x03) >> *agent_identifier_rule       [ phoenix::push_back(label::_val, label::_1) ]
+        resolvers = byte_(0x03) >> qi::eps( phoenix::cref(maxResolverDepth) == 0u || label::_r1 < phoenix::cref(maxResolverDepth) )
+                           >> *nested_agent_identifier_rule(label::_r1 + 1u)       [ phoenix::push_back(label::_val, label::_1) ]
     			   >> endOfCollection;
 
         userDefinedParameters = *userDefinedParameter [ phoenix::push_back(label::_val, label::_1) ]
@@ -133,11 +138,18 @@ struct EnvelopeAgentIdentifier : qi::grammar<Iterator, fipa::acl::AgentID()>
     BinWord<Iterator> binWord;
     BinStringNoCodetable<Iterator> binStringNoCodetable;
 
+    /**
+     * Set the maximum nesting depth of resolvers, 0 for no limit
+     * \see ParserLimits
+     */
+    void setMaxResolverDepth(size_t depth) { maxResolverDepth = depth; }
+
     qi::rule<Iterator, fipa::acl::AgentID() > agent_identifier_rule;
+    qi::rule<Iterator, fipa::acl::AgentID(boost::uint32_t) > nested_agent_identifier_rule;
     NullTerminatedString<Iterator> agentName;
 
     qi::rule<Iterator, std::vector<std::string>() > addresses;
-    qi::rule<Iterator, std::vector<fipa::acl::AgentID>() > resolvers;
+    qi::rule<Iterator, std::vector<fipa::acl::AgentID>(boost::uint32_t) > resolvers;
     qi::rule<Iterator, std::vector<fipa::acl::UserdefParam>() > userDefinedParameters;
     qi::rule<Iterator, fipa::acl::UserdefParam() > userDefinedParameter;
     qi::rule<Iterator, std::vector<std::string>() > urlCollection;
@@ -146,6 +158,7 @@ struct EnvelopeAgentIdentifier : qi::grammar<Iterator, fipa::acl::AgentID()>
     Url<Iterator> url;
     Any<Iterator> any;
     EndOfCollection<Iterator> endOfCollection;
+    size_t maxResolverDepth;
 };
 
 template <typename Iterator>
@@ -207,6 +220,11 @@ struct Envelope : qi::grammar<Iterator, fipa::acl::ACLEnvelope()>
 
         ;
 
+        // Envelopes of a letter without the payload, e.g. to frame letters in a stream
+        envelopes_rule = *extEnvelope [ phoenix::at_c<1>(label::_val) = label::_1 ]
+            >> baseEnvelope           [ phoenix::at_c<0>(label::_val) = label::_1 ]
+        ;
+
         baseEnvelope = baseEnvelopeHeader [ label::_a = label::_1 ]
             >> *parameter 		          [ label::_a = mergeBaseEnvelope(label::_a, label::_1)]
             >> endOfEnvelope              [ label::_val = label::_a ]
@@ -217,14 +235,15 @@ struct Envelope : qi::grammar<Iterator, fipa::acl::ACLEnvelope()>
             >> endOfEnvelope            [ label::_val = label::_a ]
         ;
 
+        // The envelope length is not a field of the envelope, in particular not the payload-length
         baseEnvelopeHeader = baseMsgId    
-            >> envLen                      [ phoenix::at_c<4>(label::_val) = label::_1 ]
+            >> envLen
             >> aclRepresentation           [ phoenix::at_c<2>(label::_val) = label::_1 ]
             >> date                        [ phoenix::at_c<6>(label::_val) = convertToBaseTime(label::_1) ]
         ;
 
         extEnvelopeHeader = extMsgId       
-            >> envLen                      [ phoenix::at_c<4>(label::_val) = label::_1 ]
+            >> envLen
             >> receivedObject              [ phoenix::at_c<8>(label::_val) = label::_1 ]
         ;
 
@@ -277,7 +296,8 @@ struct Envelope : qi::grammar<Iterator, fipa::acl::ACLEnvelope()>
         userDefinedACLRepresentation = byte_(0x00)
             >> nullTerminatedString [ label::_val = convertToString(label::_1) ];
 
-        payload = *byte_ [ label::_val += label::_1 ];
+        // The payload is the remainder of the letter
+        payload %= byte_block;
 
         //FIPA_DEBUG_RULE(date);
     }
@@ -287,6 +307,7 @@ struct Envelope : qi::grammar<Iterator, fipa::acl::ACLEnvelope()>
     qi::rule<Iterator, fipa::acl::UserdefinedParameterList() > customParameterList;
 
     qi::rule<Iterator, fipa::acl::ACLEnvelope()> message_envelope_rule;
+    qi::rule<Iterator, fipa::acl::ACLEnvelope()> envelopes_rule;
     qi::rule<Iterator, fipa::acl::ACLBaseEnvelope(), qi::locals<fipa::acl::ACLBaseEnvelope> > extEnvelope;
     qi::rule<Iterator, fipa::acl::ACLBaseEnvelope()> extEnvelopeHeader;
     qi::rule<Iterator, fipa::acl::ACLBaseEnvelope()> baseEnvelopeHeader;
@@ -330,6 +351,11 @@ struct Envelope : qi::grammar<Iterator, fipa::acl::ACLEnvelope()>
 
     qi::rule<Iterator, std::string() > payload;
 
+    /**
+     * Set the maximum nesting depth of resolvers in agent identifiers, 0 for no limit
+     * \see ParserLimits
+     */
+    void setMaxResolverDepth(size_t depth) { agentIdentifier.setMaxResolverDepth(depth); }
 };
 
 } // end namespace bitefficient
@@ -9,13 +9,19 @@ phoenix::function<printImpl> print;
 phoenix::function<convertDigitsToHexImpl> convertDigitsToHex;
 phoenix::function<convertToStringImpl> convertToString;
 phoenix::function<convertToCharVectorImpl> convertToCharVector;
+phoenix::function<swapIntoByteStringImpl> swapIntoByteString;
+phoenix::function<swapIntoVariantImpl> swapIntoVariant;
+phoenix::function<pushBackSwappedImpl> pushBackSwapped;
+phoenix::function<swapIntoStringImpl> swapIntoString;
 phoenix::function<convertToNativeShortImpl> lazy_ntohs;
 phoenix::function<convertToNativeLongImpl> lazy_ntohl;
 phoenix::function<createAgentIDImpl> createAgentID;
 phoenix::function<convertStringToNumberImpl> convertStringToNumber;
+phoenix::function<convertToLengthImpl> convertToLength;
 phoenix::function<digitPaddingBytesImpl> digitPaddingBytes;
 
 phoenix::function<convertToTimeImpl> convertToTime;
+phoenix::function<decodeBinDateImpl> decodeBinDate;
 phoenix::function<convertToBaseTimeImpl> convertToBaseTime;
 phoenix::function<convertToNumberTokenImpl> convertToNumberToken;
 
@@ -18,6 +18,7 @@
 #include <boost/lexical_cast.hpp>
 #include <arpa/inet.h>
 #include <ctime>
+#include <limits>
 
 #include <base/logging.h>
 
@@ -88,6 +89,112 @@ namespace qi = boost::spirit::qi;
 namespace encoding = boost::spirit::ascii;
 //namespace encoding = boost::spirit::standard;
 
+//#####################################################
+// byte_block(n): parser primitive that consumes n bytes at once
+// and assigns them with a single bounds-checked copy, i.e.
+// the replacement of qi::repeat(n)[qi::byte_] for length-prefixed data
+// byte_block: consumes all remaining bytes at once, i.e. the
+// replacement of *qi::byte_
+//#####################################################
+namespace fipa {
+namespace acl {
+namespace grammar {
+    BOOST_SPIRIT_TERMINAL_EX(byte_block)
+
+    struct byte_block_parser : boost::spirit::qi::primitive_parser<byte_block_parser>
+    {
+        template <typename Context, typename Iterator>
+        struct attribute
+        {
+            typedef std::vector<unsigned char> type;
+        };
+
+        byte_block_parser()
+            : mSize(0)
+            , mToEnd(true)
+        {}
+
+        byte_block_parser(boost::uint_least32_t size)
+            : mSize(size)
+            , mToEnd(false)
+        {}
+
+        template <typename Iterator, typename Context, typename Skipper, typename Attribute>
+        bool parse(Iterator& first, const Iterator& last, Context&, const Skipper& skipper, Attribute& attr) const
+        {
+            boost::spirit::qi::skip_over(first, last, skipper);
+            if(mToEnd)
+            {
+                boost::spirit::traits::assign_to(first, last, attr);
+                first = last;
+                return true;
+            }
+
+            if(static_cast<boost::uint_least32_t>(std::distance(first, last)) < mSize)
+            {
+                return false;
+            }
+            Iterator end = first;
+            std::advance(end, mSize);
+            boost::spirit::traits::assign_to(first, end, attr);
+            first = end;
+            return true;
+        }
+
+        template <typename Context>
+        boost::spirit::info what(Context&) const
+        {
+            return boost::spirit::info("byte_block");
+        }
+
+        boost::uint_least32_t mSize;
+        bool mToEnd;
+    };
+} // end namespace grammar
+} // end namespace acl
+} // end namespace fipa
+
+namespace boost {
+namespace spirit {
+    template <>
+    struct use_terminal<qi::domain, fipa::acl::grammar::tag::byte_block>
+        : mpl::true_ {};
+
+    template <typename A0>
+    struct use_terminal<qi::domain, terminal_ex<fipa::acl::grammar::tag::byte_block, fusion::vector1<A0> > >
+        : mpl::true_ {};
+
+    template <>
+    struct use_lazy_terminal<qi::domain, fipa::acl::grammar::tag::byte_block, 1>
+        : mpl::true_ {};
+
+namespace qi {
+    template <typename Modifiers>
+    struct make_primitive<fipa::acl::grammar::tag::byte_block, Modifiers>
+    {
+        typedef fipa::acl::grammar::byte_block_parser result_type;
+
+        result_type operator()(unused_type, unused_type) const
+        {
+            return result_type();
+        }
+    };
+
+    template <typename Modifiers, typename A0>
+    struct make_primitive<terminal_ex<fipa::acl::grammar::tag::byte_block, fusion::vector1<A0> >, Modifiers>
+    {
+        typedef fipa::acl::grammar::byte_block_parser result_type;
+
+        template <typename Terminal>
+        result_type operator()(const Terminal& term, unused_type) const
+        {
+            return result_type(fusion::at_c<0>(term.args));
+        }
+    };
+} // end namespace qi
+} // end namespace spirit
+} // end namespace boost
+
 BOOST_FUSION_ADAPT_STRUCT(
 	fipa::acl::ByteSequence,
 	(std::string, encoding)
@@ -370,16 +477,18 @@ namespace fipa {
 
 		// for std::vector<char>
 		template <typename T>
-		std::string operator()(T arg) const
+		std::string operator()(const T& arg) const
 		{
 			return std::string(arg.begin(), arg.end());
 		}
 
-		std::string operator()(fipa::acl::ByteSequence arg) const
+		std::string operator()(const fipa::acl::ByteSequence& arg) const
 		{
 			// TODO: (optional) perform some encoding stuff here
 			// using arg.encoding
-			return arg.toRawDataString();
+			std::string raw;
+			arg.toRawDataString(&raw);
+			return raw;
 		}
 
 
@@ -414,6 +523,95 @@ namespace fipa {
 	
 	extern phoenix::function<convertToCharVectorImpl> convertToCharVector;
 
+	/**
+	 * Move a parsed byte block into the bytes of a ByteSequence,
+	 * so that large blocks, e.g. the content, are not copied once more
+	 */
+	struct swapIntoByteStringImpl
+	{
+		template <typename T, typename U>
+		struct result
+		{
+			typedef void type;
+		};
+
+		template <typename T, typename U>
+		void operator()(T& byteString, U& block) const
+		{
+			byteString = U();
+			boost::get<U>(byteString).swap(block);
+		}
+	};
+	extern phoenix::function<swapIntoByteStringImpl> swapIntoByteString;
+
+	/**
+	 * Move a parsed ByteSequence into a variant, e.g. a parameter value,
+	 * without copying the bytes
+	 */
+	struct swapIntoVariantImpl
+	{
+		template <typename T, typename U>
+		struct result
+		{
+			typedef void type;
+		};
+
+		template <typename T>
+		void operator()(T& variant, fipa::acl::ByteSequence& byteSequence) const
+		{
+			variant = fipa::acl::ByteSequence();
+			boost::get<fipa::acl::ByteSequence>(variant).swap(byteSequence);
+		}
+	};
+	extern phoenix::function<swapIntoVariantImpl> swapIntoVariant;
+
+	/**
+	 * Append a parsed value to a container by swapping, e.g. to add a
+	 * message parameter holding a large content
+	 */
+	struct pushBackSwappedImpl
+	{
+		template <typename T, typename U>
+		struct result
+		{
+			typedef void type;
+		};
+
+		template <typename T, typename U>
+		void operator()(T& container, U& value) const
+		{
+			container.push_back(U());
+			container.back().swap(value);
+		}
+	};
+	extern phoenix::function<pushBackSwappedImpl> pushBackSwapped;
+
+	/**
+	 * Extract the raw data of a parsed ByteSequence into a string,
+	 * the data is swapped when it is already held as a string
+	 */
+	struct swapIntoStringImpl
+	{
+		template <typename T, typename U>
+		struct result
+		{
+			typedef void type;
+		};
+
+		template <typename T>
+		void operator()(T& target, fipa::acl::ByteSequence& byteSequence) const
+		{
+			std::string* bytes = boost::get<std::string>(&byteSequence.bytes);
+			if(bytes)
+			{
+				target.swap(*bytes);
+			} else {
+				byteSequence.toRawDataString(&target);
+			}
+		}
+	};
+	extern phoenix::function<swapIntoStringImpl> swapIntoString;
+
     struct createAgentIDImpl
     {
         template <typename T>
@@ -459,6 +657,42 @@ namespace fipa {
 
 	extern phoenix::function<convertStringToNumberImpl> convertStringToNumber;
 
+    /**
+     * Convert the digits of a byte length header into a length
+     * \return false if the digits do not represent a valid 32 bit length
+     */
+    struct convertToLengthImpl
+    {
+        template <typename T, typename U>
+        struct result
+        {
+            typedef bool type;
+        };
+
+        template <typename T, typename U>
+        bool operator()(const T& digits, U& length) const
+        {
+            boost::uint64_t value = 0;
+            typename T::const_iterator it = digits.begin();
+            for(; it != digits.end(); ++it)
+            {
+                if(*it < '0' || *it > '9')
+                {
+                    return false;
+                }
+                value = value*10 + (*it - '0');
+                if(value > std::numeric_limits<boost::uint32_t>::max())
+                {
+                    return false;
+                }
+            }
+            length = static_cast<boost::uint32_t>(value);
+            return !digits.empty();
+        }
+    };
+
+	extern phoenix::function<convertToLengthImpl> convertToLength;
+
 
 	/** Convert String to Time */
 	struct convertToTimeImpl
@@ -491,6 +725,31 @@ namespace fipa {
 
 	extern phoenix::function<convertToTimeImpl> convertToTime;
 
+	/** Decode bitefficient date (coded digit pairs) into Time */
+	struct decodeBinDateImpl
+	{
+		template <typename T, typename U>
+		struct result
+		{
+			typedef bool type;
+		};
+
+		template <typename Range>
+		bool operator()(const Range& range, fipa::acl::Time& time) const
+		{
+			unsigned char data[fipa::acl::DateTime::BIN_DATE_SIZE];
+			size_t size = 0;
+			typename Range::const_iterator it = range.begin();
+			for(; it != range.end() && size < fipa::acl::DateTime::BIN_DATE_SIZE; ++it)
+			{
+				data[size++] = static_cast<unsigned char>(*it);
+			}
+			return fipa::acl::DateTime::decodeBinDate(data, size, time);
+		}
+	};
+
+	extern phoenix::function<decodeBinDateImpl> decodeBinDate;
+
 	/** Convert Time to base::Time */
 	struct convertToBaseTimeImpl
 	{
@@ -657,7 +916,7 @@ struct ByteLengthEncodedString : qi::grammar<Iterator, fipa::acl::ByteSequence()
 	using encoding::digit;
 
 	byte_length_encoded_string_rule = byteLengthEncodedStringHeader 	[ label::_a = convertStringToNumber(label::_1) ]
-					>> qi::repeat(label::_a)[byte_]			[ phoenix::at_c<2>(label::_val) = convertToCharVector(label::_1) ]
+					>> stringBlock(label::_a)			[ swapIntoByteString(phoenix::at_c<2>(label::_val), label::_1) ]
 					;
 
 	byteLengthEncodedStringHeader = char_('#')
@@ -665,15 +924,18 @@ struct ByteLengthEncodedString : qi::grammar<Iterator, fipa::acl::ByteSequence()
 				      >> char_('"')
 				      ;
 
+	stringBlock %= byte_block(label::_r1);
+
 	FIPA_DEBUG_RULE(byte_length_encoded_string_rule);
     }
 
     qi::rule<Iterator, std::string() > byteLengthEncodedStringHeader;
+    qi::rule<Iterator, std::string(boost::uint32_t) > stringBlock;
     qi::rule<Iterator, fipa::acl::ByteSequence(), qi::locals<uint32_t> > byte_length_encoded_string_rule;
 };
 
 template<typename Iterator>
-struct ByteLengthEncodedStringTerminated : qi::grammar<Iterator, fipa::acl::ByteSequence(), qi::locals<std::string> >
+struct ByteLengthEncodedStringTerminated : qi::grammar<Iterator, fipa::acl::ByteSequence(), qi::locals<std::string, boost::uint32_t> >
 {
     ByteLengthEncodedStringTerminated() : ByteLengthEncodedStringTerminated::base_type(byte_length_encoded_string_terminated_rule, "ByteLengthEncodedStringTerminated-bitefficient_grammar")
     {
@@ -681,12 +943,20 @@ struct ByteLengthEncodedStringTerminated : qi::grammar<Iterator, fipa::acl::Byte
         using encoding::char_;
 	using encoding::digit;
 
-	byte_length_encoded_string_terminated_rule = ( byteLengthEncodedStringHeader 	[ phoenix::at_c<0>(label::_val) += label::_1 ]
+	// The announced length is used to copy the string at once, if it matches the
+	// position of the terminating 0x00, otherwise the string is read up to the terminator
+	byte_length_encoded_string_terminated_rule = ( byteLengthEncodedStringHeader 	[ phoenix::at_c<0>(label::_val) = label::_1, label::_pass = convertToLength(label::_1, label::_b) ]
+					>> stringBlock(label::_b)			[ swapIntoByteString(phoenix::at_c<2>(label::_val), label::_1) ]
+					>> byte_(0x00)
+					)
+					| ( byteLengthEncodedStringHeader 	[ phoenix::at_c<0>(label::_val) = label::_1 ]
 					>> * (byte_ - byte_(0x00))			[ label::_a += label::_1 ]
 					>> byte_(0x00)
 					) 						[ phoenix::at_c<2>(label::_val) = label::_a ] 
 					;
 
+	stringBlock %= byte_block(label::_r1);
+
 	byteLengthEncodedStringHeader = char_('#')
 				      >> + digit 	[ label::_val += label::_1 ]
 				      >> char_('"')
@@ -696,7 +966,8 @@ struct ByteLengthEncodedStringTerminated : qi::grammar<Iterator, fipa::acl::Byte
     }
 
     qi::rule<Iterator, std::string() > byteLengthEncodedStringHeader;
-    qi::rule<Iterator, fipa::acl::ByteSequence(), qi::locals<std::string> > byte_length_encoded_string_terminated_rule;
+    qi::rule<Iterator, std::string(boost::uint32_t) > stringBlock;
+    qi::rule<Iterator, fipa::acl::ByteSequence(), qi::locals<std::string, boost::uint32_t> > byte_length_encoded_string_terminated_rule;
 };
 
 template<typename Iterator>
@@ -797,53 +1068,27 @@ struct CodedNumber : qi::grammar<Iterator, std::string()>
 };
 
 template <typename Iterator>
-struct DateTime : qi::grammar<Iterator, fipa::acl::Time(), qi::locals<std::string> >
+struct DateTime : qi::grammar<Iterator, fipa::acl::Time()>
 {
     DateTime() : DateTime::base_type(date_time_rule, "DateTime-bitefficient_grammar")
     {
-
         // Construct/Fill Time()
-        // First read the standard input for struct tm
-        // then fill the extended millisecond field
-        
-        // Fixme: label::_a = string, label::_a += "-" will return only label::_a as "-"
-        // Currently using a workaround with 'buildString'
-        date_time_rule = ((        ( year	[ label::_a = buildString(label::_1,"-","") ]) //, label::_a = label::_1, label::_a += "-" ])//, print("yearinBinDate:", label::_1) ]*/ )
-        		>> ( month	[ label::_a = buildString(label::_a, label::_1,"-") ]) 
-        		>> ( day	[ label::_a = buildString(label::_a, label::_1,"T") ])
-        		>> ( hour       [ label::_a = buildString(label::_a, label::_1,":") ])
-        		>> ( minute	[ label::_a = buildString(label::_a, label::_1,":") ])
-        		>> ( second	[ label::_a = buildString(label::_a, label::_1,"")  ]) 
-        	   ) 		
-        	>> ( millisecond  	[ label::_val = convertToTime(label::_a, label::_1) ])
-        	)
-        	 ;
-        
-        year = ( codedNumber  	[ label::_val = label::_1] )
-               >> ( codedNumber [ label::_val += label::_1 ])
-               ;
-        // same format as year
-        millisecond = year.alias();
+        // The date consists of 9 bytes of coded digit pairs: YYYYMMDDhhmmss0mmm
+        // which are decoded arithmetically into the standard input for struct tm
+        // and the extended millisecond field
+        // (raw[] avoids synthesizing a vector for the date bytes)
+        date_time_rule = qi::raw[ qi::repeat(fipa::acl::DateTime::BIN_DATE_SIZE)[ codedDigitPair ] ] [ label::_pass = decodeBinDate(label::_1, label::_val) ]
+            ;
 
-    #ifdef BOOST_SPIRIT_DEBUG
-        BOOST_SPIRIT_DEBUG_NODE(year);
-        BOOST_SPIRIT_DEBUG_NODE(millisecond);
-    #endif // BOOST_SPIRIT_DEBUG
+        // two digits in one byte, padding 00 is not allowed here
+        codedDigitPair = qi::byte_ - qi::byte_(0x00)
+            ;
 
 	FIPA_DEBUG_RULE(date_time_rule);
     }
 
-    CodedNumber<Iterator> codedNumber;
-
-    qi::rule<Iterator, fipa::acl::Time(), qi::locals<std::string> > date_time_rule;
-    qi::rule<Iterator, std::string() > year;
-    CodedNumber<Iterator> month;
-    CodedNumber<Iterator> day;
-    CodedNumber<Iterator> hour;
-    CodedNumber<Iterator> minute;
-    CodedNumber<Iterator> second;
-    qi::rule<Iterator, std::string() > millisecond;
-
+    qi::rule<Iterator, fipa::acl::Time()> date_time_rule;
+    qi::rule<Iterator> codedDigitPair;
 };
 
 template<typename Iterator>
@@ -851,8 +1096,8 @@ struct String : qi::grammar<Iterator, std::string()>
 {
     String() : String::base_type(string_rule, "String-common_grammar")
     {
-	string_rule = stringLiteral     [ label::_val = convertToString(label::_1) ]
-            | byteLengthEncodedString   [ label::_val = convertToString(label::_1) ] 
+	string_rule = stringLiteral     [ swapIntoString(label::_val, label::_1) ]
+            | byteLengthEncodedString   [ swapIntoString(label::_val, label::_1) ] 
         ;
 
 	FIPA_DEBUG_RULE(string_rule);
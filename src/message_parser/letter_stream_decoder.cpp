@@ -0,0 +1,170 @@
+#include "letter_stream_decoder.h"
+#include "bitefficient_envelope_parser.h"
+#include "parser_limits.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <boost/lexical_cast.hpp>
+
+namespace fipa {
+namespace acl {
+
+LetterStreamDecoder::LetterStreamDecoder(size_t capacity)
+    : mBuffer(capacity, '\0')
+    , mBegin(0)
+    , mEnd(0)
+    , mHeaderSize(0)
+    , mLetterSize(0)
+    , mScannedSize(0)
+{}
+
+void LetterStreamDecoder::push(const char* data, size_t size)
+{
+    if(size == 0)
+    {
+        return;
+    }
+    memcpy(prepare(size), data, size);
+    commit(size);
+}
+
+void LetterStreamDecoder::push(const std::string& data)
+{
+    push(data.data(), data.size());
+}
+
+char* LetterStreamDecoder::prepare(size_t size)
+{
+    if(mBuffer.size() - mEnd < size)
+    {
+        size_t buffered = mEnd - mBegin;
+        // Move the pending data to the front of the buffer and grow only if that does not suffice
+        if(mBegin > 0)
+        {
+            memmove(&mBuffer[0], &mBuffer[mBegin], buffered);
+            mBegin = 0;
+            mEnd = buffered;
+        }
+
+        if(mBuffer.size() - mEnd < size)
+        {
+            mBuffer.resize(std::max(2*mBuffer.size(), mEnd + size));
+        }
+    }
+    return &mBuffer[mEnd];
+}
+
+void LetterStreamDecoder::commit(size_t size)
+{
+    if(mEnd + size > mBuffer.size())
+    {
+        throw std::runtime_error("LetterStreamDecoder: commit of more data than prepared");
+    }
+    mEnd += size;
+}
+
+bool LetterStreamDecoder::next(ACLEnvelope& letter)
+{
+    if(!frame())
+    {
+        return false;
+    }
+
+    letter = mEnvelope;
+    letter.setPayload(mBuffer.substr(mBegin + mHeaderSize, mLetterSize - mHeaderSize));
+    consume();
+    return true;
+}
+
+bool LetterStreamDecoder::next(std::string& letter)
+{
+    if(!frame())
+    {
+        return false;
+    }
+
+    letter.assign(mBuffer, mBegin, mLetterSize);
+    consume();
+    return true;
+}
+
+void LetterStreamDecoder::clear()
+{
+    mBegin = 0;
+    mEnd = 0;
+    mLetterSize = 0;
+    mScannedSize = 0;
+}
+
+bool LetterStreamDecoder::frame()
+{
+    size_t buffered = mEnd - mBegin;
+    if(mLetterSize)
+    {
+        return buffered >= mLetterSize;
+    }
+
+    // Retry parsing the envelopes only when new data has arrived
+    if(buffered == 0 || buffered == mScannedSize)
+    {
+        return false;
+    }
+
+    // A letter starts either with an extra envelope or the base envelope
+    unsigned char start = mBuffer[mBegin];
+    if(start != 0xfd && start != 0xfe)
+    {
+        throw std::runtime_error("LetterStreamDecoder: invalid start of letter: " + boost::lexical_cast<std::string>((int) start));
+    }
+
+    ParserLimits limits = ParserLimits::getDefault();
+
+    std::string::const_iterator begin = mBuffer.begin() + mBegin;
+    std::string::const_iterator payloadBegin;
+    mEnvelope = ACLEnvelope();
+    if(!BitefficientEnvelopeParser::parseEnvelopes(begin, mBuffer.begin() + mEnd, mEnvelope, payloadBegin))
+    {
+        // Envelopes are either incomplete or malformed, which cannot be distinguished
+        // until the maximum letter size has been exceeded
+        if(limits.exceedsMessageSize(buffered))
+        {
+            throw std::runtime_error("LetterStreamDecoder: no valid envelope within " + boost::lexical_cast<std::string>(buffered) + " bytes");
+        }
+        mScannedSize = buffered;
+        return false;
+    }
+
+    ACLBaseEnvelope flattened = mEnvelope.flattened();
+    if(!flattened.contains(envelope::PAYLOAD_LENGTH))
+    {
+        throw std::runtime_error("LetterStreamDecoder: letter without payload-length cannot be framed");
+    }
+
+    size_t headerSize = payloadBegin - begin;
+    size_t letterSize = headerSize + flattened.getPayloadLength();
+    if(limits.exceedsMessageSize(letterSize))
+    {
+        throw std::runtime_error("LetterStreamDecoder: letter of " + boost::lexical_cast<std::string>(letterSize)
+                + " bytes exceeds maximum of " + boost::lexical_cast<std::string>(limits.getMaxMessageSize()));
+    }
+    limits.validate(mEnvelope);
+
+    mHeaderSize = headerSize;
+    mLetterSize = letterSize;
+    return buffered >= mLetterSize;
+}
+
+void LetterStreamDecoder::consume()
+{
+    mBegin += mLetterSize;
+    if(mBegin == mEnd)
+    {
+        mBegin = 0;
+        mEnd = 0;
+    }
+    mLetterSize = 0;
+    mScannedSize = 0;
+}
+
+} // end namespace acl
+} // end namespace fipa
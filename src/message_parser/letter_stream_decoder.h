@@ -0,0 +1,119 @@
+#ifndef FIPA_ACL_LETTER_STREAM_DECODER_H
+#define FIPA_ACL_LETTER_STREAM_DECODER_H
+
+#include <string>
+#include <fipa_acl/message_generator/acl_envelope.h>
+
+namespace fipa {
+namespace acl {
+
+/**
+ * \class LetterStreamDecoder
+ * \brief Split a stream of concatenated bit-efficient letters into single letters
+ * \details Data can be pushed in chunks of arbitrary size, e.g. as read from a socket or file.
+ * The envelopes of the next letter are parsed once they are complete and the letter boundary
+ * is derived from the payload-length field, so that the payload itself is never scanned.
+ * Partial data is kept in an internal buffer which is reused across letters.
+ *
+ * \verbatim
+ LetterStreamDecoder decoder;
+ char* buffer = decoder.prepare(4096);
+ decoder.commit( read(fd, buffer, 4096) );
+
+ ACLEnvelope letter;
+ while(decoder.next(letter))
+ {
+     ...
+ }
+ \endverbatim
+ *
+ * Since a stream cannot be resynchronized after corrupted data, malformed input or input which exceeds
+ * the ParserLimits raises a std::runtime_error and the decoder has to be cleared.
+ */
+class LetterStreamDecoder
+{
+public:
+    /**
+     * Constructor
+     * \param capacity Initial capacity of the buffer in bytes, the buffer grows on demand
+     */
+    LetterStreamDecoder(size_t capacity = 64*1024);
+
+    /**
+     * Append data to the stream
+     */
+    void push(const char* data, size_t size);
+
+    /**
+     * Append data to the stream
+     */
+    void push(const std::string& data);
+
+    /**
+     * Reserve space at the end of the buffer to write data to directly,
+     * e.g. via read(2), the data has to be committed afterwards
+     * \param size Number of bytes to reserve
+     * \return pointer to the reserved space, valid until the next call of a non-const method
+     */
+    char* prepare(size_t size);
+
+    /**
+     * Append the given number of bytes which have been written to the space returned by prepare
+     */
+    void commit(size_t size);
+
+    /**
+     * Retrieve the next complete letter
+     * \param letter Decoded letter including the payload
+     * \return true if a letter was available, false if more data is required
+     * \throws std::runtime_error if the stream is malformed or exceeds the ParserLimits
+     */
+    bool next(ACLEnvelope& letter);
+
+    /**
+     * Retrieve the encoded data of the next complete letter
+     * \param letter Encoded letter, i.e. envelopes and payload
+     * \return true if a letter was available, false if more data is required
+     * \throws std::runtime_error if the stream is malformed or exceeds the ParserLimits
+     */
+    bool next(std::string& letter);
+
+    /**
+     * Get the number of bytes which have been pushed, but not yet retrieved
+     */
+    size_t getBufferedSize() const { return mEnd - mBegin; }
+
+    /**
+     * Drop all buffered data
+     */
+    void clear();
+
+private:
+    /**
+     * Determine the boundaries of the next letter
+     * \return true if the next letter is complete
+     */
+    bool frame();
+
+    /**
+     * Drop the current letter from the buffer
+     */
+    void consume();
+
+    std::string mBuffer;
+    size_t mBegin;
+    size_t mEnd;
+
+    // Envelope and boundaries of the current letter, valid when mLetterSize > 0
+    ACLEnvelope mEnvelope;
+    size_t mHeaderSize;
+    size_t mLetterSize;
+
+    // Buffered size at the last failed attempt to parse the envelopes
+    size_t mScannedSize;
+};
+
+} // end namespace acl
+} // end namespace fipa
+
+#endif // FIPA_ACL_LETTER_STREAM_DECODER_H
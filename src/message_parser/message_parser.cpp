@@ -1,8 +1,11 @@
 #include "bitefficient_message_parser.h"
 #include "string_message_parser.h"
 #include "xml_message_parser.h"
+#include "parser_limits.h"
+#include "representation_detector.h"
 
 #include <boost/assign/list_of.hpp>
+#include <base/logging.h>
 
 
 namespace fipa { 
@@ -16,10 +19,39 @@ std::map<representation::Type, MessageParserImplementationPtr > MessageParser::m
 
 bool MessageParser::parseData(const std::string& storage, ACLMessage &msg, fipa::acl::representation::Type representation)
 {
+    if(representation == representation::AUTO)
+    {
+        representation = RepresentationDetector::detectMessage(storage);
+        if(representation == representation::UNKNOWN)
+        {
+            LOG_WARN("MessageParser: could not detect the representation of the message");
+            return false;
+        }
+    }
+
     MessageParserImplementationPtr messageParser = msParsers[representation];
     if(messageParser)
     {
-        return messageParser->parseData(storage, msg);
+        ParserLimits limits = ParserLimits::getDefault();
+        if(limits.exceedsMessageSize(storage.size()))
+        {
+            LOG_WARN("MessageParser: rejecting message of %lu bytes, maximum is %lu", storage.size(), limits.getMaxMessageSize());
+            return false;
+        }
+
+        if(!messageParser->parseData(storage, msg))
+        {
+            return false;
+        }
+
+        try {
+            limits.validate(msg);
+        } catch(const std::runtime_error& e)
+        {
+            LOG_WARN("MessageParser: rejecting message: %s", e.what());
+            return false;
+        }
+        return true;
     } else {
         std::string msg = "MessageParser: there is no parser registered for " + representation::TypeTxt[representation];
         throw std::runtime_error(msg);
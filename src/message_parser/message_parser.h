@@ -31,7 +31,8 @@ class MessageParser
           \brief parses a correctly encoded message according to grammar_bitefficient.h and creates a Message object for internal use
         * \param storage Array of bytes that represent the bitefficient FIPA encoded message
         * \param msg The message extracted from the data
-        * \param representation the representation to decode the incoming message
+        * \param representation the representation to decode the incoming message, or representation::AUTO to detect
+        * the representation from the data, see RepresentationDetector
         * \return The decoded ACLMessage object
         */	
 	static bool parseData(const std::string& storage, ACLMessage &msg, fipa::acl::representation::Type representation = fipa::acl::representation::BITEFFICIENT);
@@ -0,0 +1,116 @@
+#include "parser_limits.h"
+#include <stdexcept>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace fipa {
+namespace acl {
+
+static boost::mutex msDefaultMutex;
+static ParserLimits msDefault;
+
+ParserLimits::ParserLimits()
+    : mMaxMessageSize(64*1024*1024)
+    , mMaxReceivers(4096)
+    , mMaxResolverDepth(16)
+    , mMaxUserdefParams(1024)
+{}
+
+ParserLimits ParserLimits::unlimited()
+{
+    ParserLimits limits;
+    limits.setMaxMessageSize(0);
+    limits.setMaxReceivers(0);
+    limits.setMaxResolverDepth(0);
+    limits.setMaxUserdefParams(0);
+    return limits;
+}
+
+void ParserLimits::setDefault(const ParserLimits& limits)
+{
+    boost::unique_lock<boost::mutex> lock(msDefaultMutex);
+    msDefault = limits;
+}
+
+ParserLimits ParserLimits::getDefault()
+{
+    boost::unique_lock<boost::mutex> lock(msDefaultMutex);
+    return msDefault;
+}
+
+void ParserLimits::validate(const ACLMessage& msg) const
+{
+    validate(msg.getAllReceivers(), "receiver");
+    validate(msg.getAllReplyTo(), "reply-to");
+    validate(msg.getSender(), "sender");
+
+    size_t params = msg.getUserdefParams().size();
+    if(exceedsUserdefParams(params))
+    {
+        throw std::runtime_error("ParserLimits: message has " + boost::lexical_cast<std::string>(params)
+                + " user defined parameters, maximum is " + boost::lexical_cast<std::string>(mMaxUserdefParams));
+    }
+}
+
+void ParserLimits::validate(const ACLEnvelope& envelope) const
+{
+    validate(envelope.getBaseEnvelope());
+    const ACLBaseEnvelopeList& extraEnvelopes = envelope.getExtraEnvelopes();
+    ACLBaseEnvelopeList::const_iterator it = extraEnvelopes.begin();
+    for(; it != extraEnvelopes.end(); ++it)
+    {
+        validate(*it);
+    }
+}
+
+void ParserLimits::validate(const ACLBaseEnvelope& envelope) const
+{
+    validate(envelope.getTo(), "to");
+    validate(envelope.getIntendedReceivers(), "intended-receiver");
+    validate(envelope.getFrom(), "from");
+}
+
+void ParserLimits::validate(const AgentIDList& agents, const std::string& field) const
+{
+    if(exceedsReceivers(agents.size()))
+    {
+        throw std::runtime_error("ParserLimits: '" + field + "' has " + boost::lexical_cast<std::string>(agents.size())
+                + " agents, maximum is " + boost::lexical_cast<std::string>(mMaxReceivers));
+    }
+
+    AgentIDList::const_iterator it = agents.begin();
+    for(; it != agents.end(); ++it)
+    {
+        validate(*it, field);
+    }
+}
+
+void ParserLimits::validate(const AgentID& agent, const std::string& field, size_t depth) const
+{
+    // Without limit there is nothing to check, and no need to descend
+    if(!mMaxResolverDepth)
+    {
+        return;
+    }
+
+    const AgentIDList& resolvers = agent.getResolvers();
+    if(resolvers.empty())
+    {
+        return;
+    }
+
+    if(exceedsResolverDepth(depth + 1))
+    {
+        throw std::runtime_error("ParserLimits: resolvers of '" + field + "' are nested deeper than "
+                + boost::lexical_cast<std::string>(mMaxResolverDepth));
+    }
+
+    AgentIDList::const_iterator it = resolvers.begin();
+    for(; it != resolvers.end(); ++it)
+    {
+        validate(*it, field, depth + 1);
+    }
+}
+
+} // end namespace acl
+} // end namespace fipa
@@ -0,0 +1,101 @@
+#ifndef FIPAACL_PARSER_LIMITS_H
+#define FIPAACL_PARSER_LIMITS_H
+
+#include <string>
+#include <fipa_acl/message_generator/acl_message.h>
+#include <fipa_acl/message_generator/acl_envelope.h>
+
+namespace fipa {
+namespace acl {
+
+/**
+ * \class ParserLimits
+ * \brief Limits on the size and structure of encoded messages and letters which are accepted by the parsers
+ * \details Input which exceeds a limit is rejected, i.e. parsing fails: the size is checked before parsing,
+ * the resolver depth while parsing, so that hostile input neither allocates
+ * arbitrary amounts of memory nor recurses arbitrarily deep.
+ * A limit of 0 disables the respective check.
+ *
+ * The limits which apply to MessageParser and EnvelopeParser are set with ParserLimits::setDefault
+ */
+class ParserLimits
+{
+public:
+    /**
+     * Create the default limits
+     */
+    ParserLimits();
+
+    /**
+     * Get limits with all checks disabled
+     */
+    static ParserLimits unlimited();
+
+    /**
+     * Set the limits which are used by all parsers
+     */
+    static void setDefault(const ParserLimits& limits);
+
+    /**
+     * Get the limits which are used by all parsers
+     */
+    static ParserLimits getDefault();
+
+    /**
+     * Set the maximum size in bytes of an encoded message or letter
+     */
+    void setMaxMessageSize(size_t size) { mMaxMessageSize = size; }
+    size_t getMaxMessageSize() const { return mMaxMessageSize; }
+
+    /**
+     * Set the maximum number of receivers of a message, or of an envelope
+     */
+    void setMaxReceivers(size_t receivers) { mMaxReceivers = receivers; }
+    size_t getMaxReceivers() const { return mMaxReceivers; }
+
+    /**
+     * Set the maximum nesting depth of resolvers, i.e. an agent identifier
+     * with resolvers which do not have resolvers themselves has depth 1
+     */
+    void setMaxResolverDepth(size_t depth) { mMaxResolverDepth = depth; }
+    size_t getMaxResolverDepth() const { return mMaxResolverDepth; }
+
+    /**
+     * Set the maximum number of user defined parameters of a message
+     */
+    void setMaxUserdefParams(size_t params) { mMaxUserdefParams = params; }
+    size_t getMaxUserdefParams() const { return mMaxUserdefParams; }
+
+    bool exceedsMessageSize(size_t size) const { return mMaxMessageSize && size > mMaxMessageSize; }
+    bool exceedsReceivers(size_t receivers) const { return mMaxReceivers && receivers > mMaxReceivers; }
+    bool exceedsResolverDepth(size_t depth) const { return mMaxResolverDepth && depth > mMaxResolverDepth; }
+    bool exceedsUserdefParams(size_t params) const { return mMaxUserdefParams && params > mMaxUserdefParams; }
+
+    /**
+     * Check a parsed message against the limits for receivers, resolver depth and
+     * user defined parameters
+     * \throw std::runtime_error naming the exceeded limit
+     */
+    void validate(const ACLMessage& msg) const;
+
+    /**
+     * Check a parsed envelope against the limits for receivers and resolver depth
+     * \throw std::runtime_error naming the exceeded limit
+     */
+    void validate(const ACLEnvelope& envelope) const;
+
+private:
+    void validate(const ACLBaseEnvelope& envelope) const;
+    void validate(const AgentIDList& agents, const std::string& field) const;
+    void validate(const AgentID& agent, const std::string& field, size_t depth = 0) const;
+
+    size_t mMaxMessageSize;
+    size_t mMaxReceivers;
+    size_t mMaxResolverDepth;
+    size_t mMaxUserdefParams;
+};
+
+} // end namespace acl
+} // end namespace fipa
+
+#endif // FIPAACL_PARSER_LIMITS_H
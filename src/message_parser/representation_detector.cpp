@@ -0,0 +1,83 @@
+#include "representation_detector.h"
+
+namespace fipa {
+namespace acl {
+
+representation::Type RepresentationDetector::detectMessage(const std::string& data)
+{
+    if(data.empty())
+    {
+        return representation::UNKNOWN;
+    }
+
+    switch(static_cast<unsigned char>(data[0]))
+    {
+        case 0xfa:
+        case 0xfb:
+        case 0xfc:
+            return representation::BITEFFICIENT;
+        default:
+            break;
+    }
+
+    switch(firstCharacter(data))
+    {
+        case '(':
+            return representation::STRING_REP;
+        case '<':
+            return representation::XML;
+        default:
+            return representation::UNKNOWN;
+    }
+}
+
+representation::Type RepresentationDetector::detectEnvelope(const std::string& data)
+{
+    if(data.empty())
+    {
+        return representation::UNKNOWN;
+    }
+
+    switch(static_cast<unsigned char>(data[0]))
+    {
+        case 0xfd:
+        case 0xfe:
+            return representation::BITEFFICIENT;
+        default:
+            break;
+    }
+
+    if(firstCharacter(data) == '<')
+    {
+        return representation::XML;
+    }
+    return representation::UNKNOWN;
+}
+
+char RepresentationDetector::firstCharacter(const std::string& data)
+{
+    std::string::const_iterator it = data.begin();
+    // Skip a UTF-8 byte order mark
+    if(data.size() >= 3 && data.compare(0, 3, "\xef\xbb\xbf") == 0)
+    {
+        it += 3;
+    }
+
+    for(; it != data.end(); ++it)
+    {
+        switch(*it)
+        {
+            case ' ':
+            case '\t':
+            case '\r':
+            case '\n':
+                continue;
+            default:
+                return *it;
+        }
+    }
+    return 0;
+}
+
+} // end namespace acl
+} // end namespace fipa
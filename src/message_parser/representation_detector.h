@@ -0,0 +1,44 @@
+#ifndef FIPA_ACL_REPRESENTATION_DETECTOR_H
+#define FIPA_ACL_REPRESENTATION_DETECTOR_H
+
+#include <string>
+#include <fipa_acl/message_generator/types.h>
+
+namespace fipa {
+namespace acl {
+
+/**
+ * \class RepresentationDetector
+ * \brief Detect the representation of encoded messages and letters from their first bytes
+ * \details Only the message identifier of the bit-efficient representation, i.e. 0xfa, 0xfb or 0xfc for messages
+ * and 0xfe or 0xfd for envelopes, and the first character after leading whitespace, i.e. '(' for the string
+ * and '<' for the xml representation, are inspected. The data is not validated, which is left to the parser.
+ * MessageParser and EnvelopeParser use the detector for representation::AUTO
+ */
+class RepresentationDetector
+{
+public:
+    /**
+     * Detect the representation of an encoded message
+     * \return the representation, or representation::UNKNOWN if the data matches no representation
+     */
+    static representation::Type detectMessage(const std::string& data);
+
+    /**
+     * Detect the representation of an encoded letter, i.e. envelope and payload
+     * \return the representation, or representation::UNKNOWN if the data matches no representation
+     */
+    static representation::Type detectEnvelope(const std::string& data);
+
+private:
+    /**
+     * Get the first character which is not whitespace
+     * \return the character, or 0 if there is none
+     */
+    static char firstCharacter(const std::string& data);
+};
+
+} // end namespace acl
+} // end namespace fipa
+
+#endif // FIPA_ACL_REPRESENTATION_DETECTOR_H
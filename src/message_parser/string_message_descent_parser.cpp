@@ -0,0 +1,822 @@
+#include "string_message_descent_parser.h"
+
+#include <stdint.h>
+#include <stdexcept>
+#include <vector>
+#include <fipa_acl/message_generator/message_format.h>
+#include <fipa_acl/message_generator/userdef_param.h>
+#include <base/Logging.hpp>
+
+namespace fipa {
+namespace acl {
+
+namespace {
+
+/**
+ * Keywords which terminate a word, i.e. message fields and
+ * the fields which are possible inside an agent-identifier
+ */
+const std::vector<std::string>& getKeywords()
+{
+    static std::vector<std::string> keywords;
+    if(keywords.empty())
+    {
+        using namespace MessageField;
+        std::vector<std::string> k;
+        for(int i = SENDER; i <= CONVERSATION_ID; ++i)
+        {
+            k.push_back(":" + MessageFieldTxt[(MessageField::Type) i]);
+        }
+        k.push_back(":resolvers");
+        k.push_back(":addresses");
+        keywords.swap(k);
+    }
+    return keywords;
+}
+
+/**
+ * Performatives in the order in which they are tested, i.e. the more specific
+ * ones (request-whenever) before the less specific ones (request)
+ */
+const std::vector<std::string>& getPerformatives()
+{
+    static std::vector<std::string> performatives;
+    if(performatives.empty())
+    {
+        ACLMessage::Performative order[] = {
+            ACLMessage::ACCEPT_PROPOSAL, ACLMessage::AGREE, ACLMessage::CANCEL, ACLMessage::CALL_FOR_PROPOSAL,
+            ACLMessage::CONFIRM, ACLMessage::DISCONFIRM, ACLMessage::FAILURE, ACLMessage::INFORM_IF,
+            ACLMessage::INFORM_REF, ACLMessage::INFORM, ACLMessage::NOT_UNDERSTOOD, ACLMessage::PROPAGATE,
+            ACLMessage::PROPOSE, ACLMessage::PROXY, ACLMessage::QUERY_IF, ACLMessage::QUERY_REF,
+            ACLMessage::REFUSE, ACLMessage::REJECT_PROPOSAL, ACLMessage::REQUEST_WHENEVER, ACLMessage::REQUEST_WHEN,
+            ACLMessage::REQUEST, ACLMessage::SUBSCRIBE };
+
+        std::vector<std::string> p;
+        for(size_t i = 0; i < sizeof(order)/sizeof(order[0]); ++i)
+        {
+            p.push_back(PerformativeTxt[order[i]]);
+        }
+        performatives.swap(p);
+    }
+    return performatives;
+}
+
+inline char toLower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+}
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/**
+ * Characters that can never be part of a word: non-ascii, control characters,
+ * space and parentheses
+ */
+inline bool isWordException(char c)
+{
+    unsigned char u = c;
+    return u <= 0x20 || u >= 0x80 || c == '(' || c == ')';
+}
+
+inline bool isWordStartException(char c)
+{
+    return isWordException(c) || c == '#' || isDigit(c) || c == '-' || c == '@';
+}
+
+/**
+ * Convert a date time token (+YYYYMMDDThhmmssmmm[type designator]) to base::Time
+ */
+base::Time convertToBaseTime(const std::string& token)
+{
+    std::string time = token;
+    if(time[0] == '-' || time[0] == '+')
+    {
+        time.erase(0,1);
+    }
+    std::string format = "%Y%m%dT%H%M%S";
+
+    size_t end = time.find_last_of("0123456789", time.size() - 1);
+    if(end < time.size() - 1)
+    {
+        // the type designator is present
+        format += "%Z";
+    }
+
+    // Shift millisecond so that base::Time understands the format
+    std::string milliseconds = time.substr(end-2,3);
+    time.erase(end-2,3);
+    time += ":" + milliseconds;
+
+    return base::Time::fromString(time, base::Time::Milliseconds, format);
+}
+
+/**
+ * Parser state -- all parse functions leave the position unchanged if they fail
+ *
+ * Spaces are skipped where the Spirit grammar uses a skipper, i.e. between the tokens of a
+ * message, an agent-identifier, a set or a sequence and within expressions of message fields,
+ * but not inside of words, strings, numbers and userdefined parameters
+ */
+class Parser
+{
+public:
+    Parser(const std::string& storage)
+        : mPos(storage.data())
+        , mEnd(storage.data() + storage.size())
+    {}
+
+    bool parseMessage(ACLMessage& msg)
+    {
+        const char* start = mPos;
+        std::string performative;
+
+        skipSpace();
+        if(!match('(') || (skipSpace(), !parsePerformative(performative)))
+        {
+            mPos = start;
+            return false;
+        }
+        msg.setPerformative(performative);
+
+        for(;;)
+        {
+            const char* field = mPos;
+            skipSpace();
+            if(!parseMessageField(msg))
+            {
+                mPos = field;
+                break;
+            }
+        }
+
+        skipSpace();
+        if(!match(')'))
+        {
+            mPos = start;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    const char* mPos;
+    const char* mEnd;
+
+    void skipSpace()
+    {
+        while(mPos != mEnd && isSpace(*mPos))
+        {
+            ++mPos;
+        }
+    }
+
+    bool match(char c)
+    {
+        if(mPos != mEnd && *mPos == c)
+        {
+            ++mPos;
+            return true;
+        }
+        return false;
+    }
+
+    bool matchesAt(const char* pos, const std::string& literal, bool noCase) const
+    {
+        if((size_t) (mEnd - pos) < literal.size())
+        {
+            return false;
+        }
+        for(size_t i = 0; i < literal.size(); ++i)
+        {
+            char c = noCase ? toLower(pos[i]) : pos[i];
+            if(c != literal[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Match a literal, case insensitive if requested (literal has to be lowercase then)
+     */
+    bool match(const std::string& literal, bool noCase = true)
+    {
+        if(matchesAt(mPos, literal, noCase))
+        {
+            mPos += literal.size();
+            return true;
+        }
+        return false;
+    }
+
+    bool isKeywordAt(const char* pos) const
+    {
+        if(*pos != ':')
+        {
+            return false;
+        }
+        const std::vector<std::string>& keywords = getKeywords();
+        for(size_t i = 0; i < keywords.size(); ++i)
+        {
+            if(matchesAt(pos, keywords[i], true))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool parsePerformative(std::string& performative)
+    {
+        const std::vector<std::string>& performatives = getPerformatives();
+        for(size_t i = 0; i < performatives.size(); ++i)
+        {
+            if(matchesAt(mPos, performatives[i], true))
+            {
+                performative.assign(mPos, performatives[i].size());
+                mPos += performatives[i].size();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Word which stops at keywords, e.g. name:sender is the word 'name'
+     */
+    bool parseWord(std::string& word)
+    {
+        if(mPos == mEnd || isWordStartException(*mPos))
+        {
+            return false;
+        }
+        const char* start = mPos++;
+        while(mPos != mEnd && !isWordException(*mPos) && !isKeywordAt(mPos))
+        {
+            ++mPos;
+        }
+        word.assign(start, mPos - start);
+        return true;
+    }
+
+    /**
+     * String literal "..." where \" is an escaped quote
+     */
+    bool parseStringLiteral(std::string& txt)
+    {
+        const char* start = mPos;
+        if(!match('"'))
+        {
+            return false;
+        }
+        std::string literal;
+        while(mPos != mEnd)
+        {
+            if(*mPos == '\\' && mPos + 1 != mEnd && mPos[1] == '"')
+            {
+                literal += '"';
+                mPos += 2;
+            } else if(*mPos != '"')
+            {
+                literal += *mPos++;
+            } else {
+                break;
+            }
+        }
+        if(!match('"'))
+        {
+            mPos = start;
+            return false;
+        }
+        txt.swap(literal);
+        return true;
+    }
+
+    /**
+     * Byte-length encoded string #N"... -- only the position of the data is returned
+     */
+    bool parseByteLengthEncodedString(const char*& data, size_t& size)
+    {
+        const char* start = mPos;
+        if(!match('#'))
+        {
+            return false;
+        }
+        const char* digits = mPos;
+        uint64_t length = 0;
+        while(mPos != mEnd && isDigit(*mPos))
+        {
+            length = length*10 + (*mPos++ - '0');
+            if(length > 0xffffffffULL)
+            {
+                std::string msg = "ConvertStringToNumber failed for '" + std::string(digits, mPos - digits) + "'";
+                LOG_ERROR("%s", msg.c_str());
+                throw std::runtime_error(msg);
+            }
+        }
+        if(mPos == digits || !match('"') || (uint64_t) (mEnd - mPos) < length)
+        {
+            mPos = start;
+            return false;
+        }
+        data = mPos;
+        size = length;
+        mPos += length;
+        return true;
+    }
+
+    /**
+     * String, either as literal or byte-length encoded -- data refers either into
+     * the input or into buffer
+     */
+    bool parseString(const char*& data, size_t& size, std::string& buffer)
+    {
+        if(parseStringLiteral(buffer))
+        {
+            data = buffer.data();
+            size = buffer.size();
+            return true;
+        }
+        return parseByteLengthEncodedString(data, size);
+    }
+
+    bool parseString(std::string& txt)
+    {
+        const char* data;
+        size_t size;
+        std::string buffer;
+        if(!parseString(data, size, buffer))
+        {
+            return false;
+        }
+        if(data == buffer.data())
+        {
+            txt.swap(buffer);
+        } else {
+            txt.assign(data, size);
+        }
+        return true;
+    }
+
+    void skipSign()
+    {
+        if(mPos != mEnd && (*mPos == '+' || *mPos == '-'))
+        {
+            ++mPos;
+        }
+    }
+
+    size_t skipDigits()
+    {
+        const char* start = mPos;
+        while(mPos != mEnd && isDigit(*mPos))
+        {
+            ++mPos;
+        }
+        return mPos - start;
+    }
+
+    bool skipExponent()
+    {
+        const char* start = mPos;
+        if(mPos == mEnd || (*mPos != 'e' && *mPos != 'E'))
+        {
+            return false;
+        }
+        ++mPos;
+        skipSign();
+        if(skipDigits() == 0)
+        {
+            mPos = start;
+            return false;
+        }
+        return true;
+    }
+
+    bool skipFloatMantissa()
+    {
+        const char* start = mPos;
+        size_t integerDigits = skipDigits();
+        if(!match('.'))
+        {
+            mPos = start;
+            return false;
+        }
+        size_t fractionDigits = skipDigits();
+        if(integerDigits == 0 && fractionDigits == 0)
+        {
+            mPos = start;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Number, i.e. float or integer, returned as matched
+     */
+    bool parseNumber(std::string& number)
+    {
+        const char* start = mPos;
+        skipSign();
+        if(skipFloatMantissa())
+        {
+            skipExponent();
+        } else if(skipDigits() == 0)
+        {
+            mPos = start;
+            return false;
+        } else {
+            // integer, or float without mantissa, e.g. 12e4
+            skipExponent();
+        }
+        number.assign(start, mPos - start);
+        return true;
+    }
+
+    bool parseExpressionBase(std::string& expression)
+    {
+        // The date time token is not tested here, since a number always
+        // matches the date first
+        return parseString(expression)
+            || parseNumber(expression)
+            || parseWord(expression);
+    }
+
+    /**
+     * Expression, where nested expressions in parentheses are concatenated with
+     * a single space
+     */
+    bool parseExpression(std::string& expression, bool skip)
+    {
+        const char* start = mPos;
+        if(skip)
+        {
+            skipSpace();
+        }
+
+        std::string base;
+        if(parseExpressionBase(base))
+        {
+            expression.swap(base);
+            return true;
+        }
+
+        if(!match('('))
+        {
+            mPos = start;
+            return false;
+        }
+
+        std::string concatenated;
+        for(;;)
+        {
+            const char* nested = mPos;
+            std::string subexpression;
+            if(!parseExpression(subexpression, skip))
+            {
+                mPos = nested;
+                break;
+            }
+            if(concatenated.empty())
+            {
+                concatenated.swap(subexpression);
+            } else {
+                concatenated += " ";
+                concatenated += subexpression;
+            }
+        }
+
+        if(skip)
+        {
+            skipSpace();
+        }
+        if(!match(')'))
+        {
+            mPos = start;
+            return false;
+        }
+        expression.swap(concatenated);
+        return true;
+    }
+
+    bool parseDateTime(base::Time& time)
+    {
+        const char* start = mPos;
+        skipSign();
+        const size_t digits[] = { 8, 9 };
+        // YYYYMMDD 'T' hhmmssmmm
+        for(size_t i = 0; i < 2; ++i)
+        {
+            for(size_t d = 0; d < digits[i]; ++d)
+            {
+                if(!(mPos != mEnd && isDigit(*mPos)))
+                {
+                    mPos = start;
+                    return false;
+                }
+                ++mPos;
+            }
+            if(i == 0 && !match('T'))
+            {
+                mPos = start;
+                return false;
+            }
+        }
+        // Optional type designator
+        if(mPos != mEnd && ((*mPos >= 'a' && *mPos <= 'z') || (*mPos >= 'A' && *mPos <= 'Z')))
+        {
+            ++mPos;
+        }
+        time = convertToBaseTime(std::string(start, mPos - start));
+        return true;
+    }
+
+    bool parseUrlSequence(std::vector<std::string>& urls)
+    {
+        const char* start = mPos;
+        skipSpace();
+        if(!match('(') || (skipSpace(), !match("sequence")))
+        {
+            mPos = start;
+            return false;
+        }
+        for(;;)
+        {
+            const char* element = mPos;
+            skipSpace();
+            std::string url;
+            if(!parseWord(url))
+            {
+                mPos = element;
+                break;
+            }
+            urls.push_back(url);
+        }
+        skipSpace();
+        if(!match(')'))
+        {
+            mPos = start;
+            return false;
+        }
+        return true;
+    }
+
+    bool parseUserdefinedParameter(UserdefParam& param)
+    {
+        const char* start = mPos;
+        std::string name;
+        std::string value;
+        if(!match(":X-", false) || !parseWord(name) || !parseExpression(value, false))
+        {
+            mPos = start;
+            return false;
+        }
+        param = UserdefParam(name, value);
+        return true;
+    }
+
+    /**
+     * Agent identifier -- resolvers are only allowed at the top level, i.e. not for
+     * agent identifiers which are resolvers themselves
+     */
+    bool parseAgentIdentifier(AgentID& agent, bool withResolvers)
+    {
+        const char* start = mPos;
+        std::string name;
+        skipSpace();
+        if(!match('(')
+                || (skipSpace(), !match("agent-identifier"))
+                || (skipSpace(), !match(":name"))
+                || (skipSpace(), !parseWord(name)))
+        {
+            mPos = start;
+            return false;
+        }
+
+        AgentID parsedAgent;
+        parsedAgent.setName(name);
+
+        const char* optional = mPos;
+        std::vector<std::string> addresses;
+        skipSpace();
+        if(match(":addresses") && parseUrlSequence(addresses))
+        {
+            parsedAgent.setAddresses(addresses);
+        } else {
+            mPos = optional;
+        }
+
+        if(withResolvers)
+        {
+            optional = mPos;
+            AgentIDList resolvers;
+            skipSpace();
+            if(match(":resolvers") && parseAgentIdentifierList(resolvers, "sequence", false))
+            {
+                parsedAgent.setResolvers(resolvers);
+            } else {
+                mPos = optional;
+            }
+        }
+
+        optional = mPos;
+        skipSpace();
+        std::vector<UserdefParam> params;
+        UserdefParam param;
+        while(parseUserdefinedParameter(param))
+        {
+            params.push_back(param);
+        }
+        if(params.empty())
+        {
+            mPos = optional;
+        } else {
+            parsedAgent.setUserdefParams(params);
+        }
+
+        skipSpace();
+        if(!match(')'))
+        {
+            mPos = start;
+            return false;
+        }
+        agent = parsedAgent;
+        return true;
+    }
+
+    /**
+     * Agent identifier set or sequence
+     */
+    bool parseAgentIdentifierList(AgentIDList& agents, const std::string& label, bool withResolvers)
+    {
+        const char* start = mPos;
+        skipSpace();
+        if(!match('(') || (skipSpace(), !match(label)))
+        {
+            mPos = start;
+            return false;
+        }
+        AgentIDList parsedAgents;
+        for(;;)
+        {
+            const char* element = mPos;
+            AgentID agent;
+            if(!parseAgentIdentifier(agent, withResolvers))
+            {
+                mPos = element;
+                break;
+            }
+            parsedAgents.push_back(agent);
+        }
+        skipSpace();
+        if(!match(')'))
+        {
+            mPos = start;
+            return false;
+        }
+        agents.swap(parsedAgents);
+        return true;
+    }
+
+    bool parseMessageField(ACLMessage& msg)
+    {
+        using namespace MessageField;
+
+        const std::vector<std::string>& keywords = getKeywords();
+        int field = SENDER;
+        for(; field <= CONVERSATION_ID; ++field)
+        {
+            if(match(keywords[field - SENDER]))
+            {
+                break;
+            }
+        }
+
+        if(field > CONVERSATION_ID)
+        {
+            UserdefParam param;
+            if(!parseUserdefinedParameter(param))
+            {
+                return false;
+            }
+            msg.addUserdefParam(param);
+            return true;
+        }
+
+        skipSpace();
+        switch(field)
+        {
+            case SENDER:
+            {
+                AgentID sender;
+                if(!parseAgentIdentifier(sender, true))
+                {
+                    return false;
+                }
+                msg.setSender(sender);
+                return true;
+            }
+            case RECEIVER:
+            case REPLY_TO:
+            {
+                AgentIDList agents;
+                if(!parseAgentIdentifierList(agents, "set", true))
+                {
+                    return false;
+                }
+                if(field == RECEIVER)
+                {
+                    msg.setAllReceivers(agents);
+                } else {
+                    msg.setAllReplyTo(agents);
+                }
+                return true;
+            }
+            case CONTENT:
+            {
+                // Content is copied only once from the input into the message
+                const char* data;
+                size_t size;
+                std::string buffer;
+                if(!parseString(data, size, buffer))
+                {
+                    return false;
+                }
+                msg.setContent(data, size);
+                return true;
+            }
+            case REPLY_BY:
+            {
+                base::Time replyBy;
+                if(!parseDateTime(replyBy))
+                {
+                    return false;
+                }
+                msg.setReplyBy(replyBy);
+                return true;
+            }
+            case PROTOCOL:
+            {
+                std::string protocol;
+                if(!parseWord(protocol))
+                {
+                    return false;
+                }
+                msg.setProtocol(protocol);
+                return true;
+            }
+            default:
+                break;
+        }
+
+        std::string expression;
+        if(!parseExpression(expression, true))
+        {
+            return false;
+        }
+        switch(field)
+        {
+            case REPLY_WITH:
+                msg.setReplyWith(expression);
+                break;
+            case IN_REPLY_TO:
+                msg.setInReplyTo(expression);
+                break;
+            case LANGUAGE:
+                msg.setLanguage(expression);
+                break;
+            case ENCODING:
+                msg.setEncoding(expression);
+                break;
+            case ONTOLOGY:
+                msg.setOntology(expression);
+                break;
+            case CONVERSATION_ID:
+                msg.setConversationID(expression);
+                break;
+            default:
+                break;
+        }
+        return true;
+    }
+};
+
+} // end anonymous namespace
+
+bool StringMessageDescentParser::parse(const std::string& storage, ACLMessage& msg)
+{
+    Parser parser(storage);
+    return parser.parseMessage(msg);
+}
+
+} // end namespace acl
+} // end namespace fipa
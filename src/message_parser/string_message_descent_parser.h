@@ -0,0 +1,35 @@
+#ifndef FIPAACL_STRING_MESSAGE_DESCENT_PARSER_H
+#define FIPAACL_STRING_MESSAGE_DESCENT_PARSER_H
+
+#include <string>
+#include <fipa_acl/message_generator/acl_message.h>
+
+namespace fipa {
+namespace acl {
+
+/**
+ * \class StringMessageDescentParser
+ * \brief Hand-written recursive-descent parser for the string representation (fipa.acl.rep.string.std)
+ *
+ * The parser accepts the same language as the Spirit grammar in grammar/grammar_string_message.h
+ * and fills the message in the same way, but works directly on the input buffer: byte-length
+ * encoded strings #N"... are copied with a single bounds-checked copy
+ * \see StringMessageParser::setImplementation
+ */
+class StringMessageDescentParser
+{
+public:
+    /**
+     * Parse a string encoded message
+     * \param storage Encoded message
+     * \param msg Message to fill
+     * \return true if the message could be parsed, false otherwise
+     * \throw std::runtime_error if a field contains an invalid value, e.g. an invalid agent name
+     */
+    static bool parse(const std::string& storage, ACLMessage& msg);
+};
+
+} // end namespace acl
+} // end namespace fipa
+
+#endif // FIPAACL_STRING_MESSAGE_DESCENT_PARSER_H
@@ -1,19 +1,46 @@
 #include "string_message_parser.h"
+#include "string_message_descent_parser.h"
 
 #include "grammar/grammar_string_message.h"
+#include <boost/atomic.hpp>
+#include <boost/thread/tss.hpp>
 #include <base/Logging.hpp>
 
 namespace fipa {
 namespace acl {
 
+typedef fipa::acl::grammar::string::Message<std::string::const_iterator, qi::space_type> string_message_grammar;
+
+// The grammar is expensive to construct, so that it is constructed once per thread
+static boost::thread_specific_ptr<string_message_grammar> msGrammar;
+
+static boost::atomic<int> msImplementation(string_parser::SPIRIT);
+
+void StringMessageParser::setImplementation(string_parser::Type type)
+{
+    msImplementation = type;
+}
+
+string_parser::Type StringMessageParser::getImplementation()
+{
+    return static_cast<string_parser::Type>(msImplementation.load());
+}
+
 bool StringMessageParser::parseData(const std::string& storage, ACLMessage& msg)
 {
-    typedef fipa::acl::grammar::string::Message<std::string::const_iterator, qi::space_type> string_message_grammar;
-    string_message_grammar grammar;
+    if(msImplementation == string_parser::DESCENT)
+    {
+        return StringMessageDescentParser::parse(storage, msg);
+    }
+
+    if(!msGrammar.get())
+    {
+        msGrammar.reset(new string_message_grammar());
+    }
 
     std::string::const_iterator iter = storage.begin();
     std::string::const_iterator end = storage.end();
-    return phrase_parse(iter, end, grammar, qi::space, msg);
+    return phrase_parse(iter, end, *msGrammar, qi::space, msg);
 }
 
 } // end namespace acl
@@ -6,9 +6,29 @@
 namespace fipa {
 namespace acl {
 
+namespace string_parser {
+    /**
+     * Available implementations to parse the string representation
+     */
+    enum Type { SPIRIT = 0, DESCENT };
+}
+
 class StringMessageParser : public MessageParserImplementation
 {
+public:
     bool parseData(const std::string& storage, ACLMessage& msg); 
+
+    /**
+     * Select the implementation which is used to parse messages in string representation,
+     * i.e. the Spirit grammar (default) or the hand-written recursive-descent parser
+     * (StringMessageDescentParser), which accept the same language
+     */
+    static void setImplementation(string_parser::Type type);
+
+    /**
+     * Get the implementation which is used to parse messages in string representation
+     */
+    static string_parser::Type getImplementation();
 };
 
 } // end namespace acl
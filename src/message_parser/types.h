@@ -57,6 +57,15 @@ struct Parameter
                 return tmp;
         }
 
+        /**
+         * Exchange name and value with another parameter without copying the value
+         */
+        void swap(Parameter& other)
+        {
+                name.swap(other.name);
+                data.swap(other.data);
+        }
+
 };
 
 }
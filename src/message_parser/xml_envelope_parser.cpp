@@ -103,10 +103,15 @@ const ACLBaseEnvelope XMLEnvelopeParser::parseParameters(const TiXmlElement* par
     {
         throw std::runtime_error("Parsing error: params node not named 'params' but " + paramsElem->ValueStr());
     }
-    if(*(paramsElem->Attribute(std::string("index"))) != boost::lexical_cast<std::string>(paramsIndex))
+    const std::string* index = paramsElem->Attribute(std::string("index"));
+    if(index == NULL)
+    {
+        throw std::runtime_error("Parsing error: params index attribute is missing");
+    }
+    if(*index != boost::lexical_cast<std::string>(paramsIndex))
     {
         throw std::runtime_error("Parsing error: params index attribute should be " +
-            boost::lexical_cast<std::string>(paramsIndex) + " but is " + paramsElem->Attribute("index"));
+            boost::lexical_cast<std::string>(paramsIndex) + " but is " + *index);
     }
     
     ACLBaseEnvelope envelope;
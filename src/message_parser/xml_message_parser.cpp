@@ -24,6 +24,12 @@ bool XMLMessageParser::parseData(const std::string& storage, ACLMessage& msg)
     // The main node (fipa-message)
     const TiXmlElement* messageElem = doc.FirstChildElement();
     
+    if(messageElem == NULL)
+    {
+        LOG_WARN_S << "Parsing error: XML main node not found.";
+        return false;
+    }
+
     if(messageElem->ValueStr() != "fipa-message")
     {
         LOG_WARN_S << "Parsing error: XML main node not named 'fipa-message' but " << messageElem->ValueStr();
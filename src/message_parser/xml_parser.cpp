@@ -1,11 +1,12 @@
 #include "xml_parser.h"
+#include "parser_limits.h"
 #include <base/Time.hpp>
 #include <stdexcept>
 
 namespace fipa {
 namespace acl {
 
-const AgentID XMLParser::parseAgentID(const TiXmlElement* aidElem)
+const AgentID XMLParser::parseAgentID(const TiXmlElement* aidElem, size_t depth)
 {
     if(aidElem->ValueStr() != "agent-identifier")
     {
@@ -34,7 +35,11 @@ const AgentID XMLParser::parseAgentID(const TiXmlElement* aidElem)
         else if(text == "resolvers")
         {
             // It's a list of agent ids
-            aid.setResolvers(parseAgentIDSequence(pChild));
+            if(ParserLimits::getDefault().exceedsResolverDepth(depth + 1))
+            {
+                throw std::runtime_error("Parsing error: resolvers are nested deeper than the parser limit");
+            }
+            aid.setResolvers(parseAgentIDSequence(pChild, depth + 1));
         }
         else if(text.substr(0, 2) == "X-")
         {
@@ -44,14 +49,14 @@ const AgentID XMLParser::parseAgentID(const TiXmlElement* aidElem)
     return aid;
 }
 
-const AgentIDList XMLParser::parseAgentIDSequence(const TiXmlElement* aidlElem)
+const AgentIDList XMLParser::parseAgentIDSequence(const TiXmlElement* aidlElem, size_t depth)
 {
     AgentIDList list;
     // All children are AgentIDs
     const TiXmlElement * pChild;
     for ( pChild = aidlElem->FirstChildElement(); pChild != 0; pChild = pChild->NextSiblingElement()) 
     {
-        list.push_back(parseAgentID(pChild));
+        list.push_back(parseAgentID(pChild, depth));
     }
     return list;
 }
@@ -68,6 +73,10 @@ const base::Time XMLParser::parseDate(const TiXmlElement* dateElem)
 
 const std::string XMLParser::parseName(const TiXmlElement* nameElem)
 {
+    if(nameElem == NULL)
+    {
+        throw std::runtime_error("Parsing error: node 'name' is missing");
+    }
     if(nameElem->ValueStr() != "name")
     {
         throw std::runtime_error("Parsing error: node not named 'name' but " + nameElem->ValueStr());
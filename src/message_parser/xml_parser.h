@@ -23,8 +23,13 @@ public:
     static const base::Time strToDate(const std::string& dateStr);
     static const std::string parseURL(const TiXmlElement* urlElem);
     static const std::string parseName(const TiXmlElement* nameElem);
-    static const AgentID parseAgentID(const TiXmlElement* aidElem);
-    static const AgentIDList parseAgentIDSequence(const TiXmlElement* aidlElem);
+    /**
+     * Parse an agent identifier
+     * \param depth Nesting depth of the agent identifier, i.e. 0 for an agent identifier which is not a resolver
+     * \throw std::runtime_error if resolvers are nested deeper than allowed by ParserLimits
+     */
+    static const AgentID parseAgentID(const TiXmlElement* aidElem, size_t depth = 0);
+    static const AgentIDList parseAgentIDSequence(const TiXmlElement* aidlElem, size_t depth = 0);
     static const UserdefParam parseUserdefinedParameter(const TiXmlElement* paramElem);
     /**
      * For all message parameters FIPA allows to set the content directly or to point to
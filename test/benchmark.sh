@@ -18,3 +18,8 @@ do
    echo "${BENCHMARK} ${size} ${epoch} >> ${OUTPUT}"
    `${BENCHMARK} ${size} ${epoch} >> ${OUTPUT}`
 done
+
+SUITE=../build/src/fipa_acl-benchmark_suite
+if [ -x "${SUITE}" ]; then
+    ${SUITE} -f json -p ../configuration/protocols -o suite-$TIMESTAMP.json
+fi
@@ -4,8 +4,12 @@
  */
 #include <boost/test/auto_unit_test.hpp>
 #include <iostream>
+#include <sstream>
 #include <fipa_acl/fipa_acl.h>
 #include <fipa_acl/conversation_monitor.h>
+#include <fstream>
+#include <boost/filesystem.hpp>
+#include <boost/thread/thread.hpp>
 #include "utils.h"
 
 BOOST_AUTO_TEST_SUITE(conversation_monitor_suite)
@@ -221,9 +225,71 @@ BOOST_AUTO_TEST_CASE(state_test)
 
     transitions = finalState.getTransitions();
     BOOST_REQUIRE(transitions.empty());
+
+    // Transition lookup for predefined and custom performatives
+    {
+        State dispatchState("dispatch");
+        dispatchState.addTransition(Transition(senderRole, receiverRole, "inform|agree", "dispatch", "informed"));
+        dispatchState.addTransition(Transition(senderRole, receiverRole, "custom-.*", "dispatch", "custom"));
+        dispatchState.addTransition(Transition(senderRole, receiverRole, ".*", "dispatch", "any"));
+
+        MessageArchive archive;
+        RoleMapping roleMapping;
+
+        const Transition* transition = dispatchState.findTransition(ACLMessage(ACLMessage::AGREE), archive, roleMapping);
+        BOOST_REQUIRE(transition && transition->getTargetStateId() == "informed");
+        transition = dispatchState.findTransition(ACLMessage("custom-performative"), archive, roleMapping);
+        BOOST_REQUIRE(transition && transition->getTargetStateId() == "custom");
+        transition = dispatchState.findTransition(ACLMessage(ACLMessage::REQUEST), archive, roleMapping);
+        BOOST_REQUIRE(transition && transition->getTargetStateId() == "any");
+
+        State emptyState("empty");
+        BOOST_REQUIRE(emptyState.findTransition(ACLMessage(ACLMessage::REQUEST), archive, roleMapping) == NULL);
+        BOOST_REQUIRE_THROW(emptyState.getTransition(ACLMessage(ACLMessage::REQUEST), archive, roleMapping), std::runtime_error);
+    }
 }
 
 
+BOOST_AUTO_TEST_CASE(role_mapping_test)
+{
+    using namespace fipa::acl;
+
+    Role bidder("bidder");
+    Role patternRole("agent-.*");
+    BOOST_REQUIRE(!bidder.isPattern());
+    BOOST_REQUIRE(patternRole.isPattern());
+    BOOST_REQUIRE(patternRole.matches("agent-1"));
+    BOOST_REQUIRE(!bidder.matches("bidder-1"));
+
+    RoleMapping roleMapping;
+    roleMapping.addRole(bidder);
+    BOOST_REQUIRE(roleMapping.findExpectedAgents(Role("unknown")) == NULL);
+    BOOST_REQUIRE_THROW(roleMapping.getExpectedAgents(Role("unknown")), std::runtime_error);
+
+    // Unassigned role accepts any agent
+    BOOST_REQUIRE(roleMapping.isExpected(bidder, AgentID("bidder-0")));
+
+    for(int i = 0; i < 100; ++i)
+    {
+        std::stringstream ss;
+        ss << "bidder-" << i;
+        roleMapping.addExpectedAgent(bidder, AgentID(ss.str()));
+    }
+    BOOST_REQUIRE(roleMapping.findExpectedAgents(bidder)->size() == 100);
+    BOOST_REQUIRE(roleMapping.isBound(bidder, AgentID("bidder-42")));
+    BOOST_REQUIRE(roleMapping.isExpected(bidder, AgentID("bidder-99")));
+    BOOST_REQUIRE(!roleMapping.isExpected(bidder, AgentID("bidder-100")));
+
+    // Expected agent names that are patterns are matched as regular expression
+    roleMapping.addExpectedAgent(bidder, AgentID("late-bidder-[0-9]+"));
+    BOOST_REQUIRE(roleMapping.isExpected(bidder, AgentID("late-bidder-7")));
+    BOOST_REQUIRE(!roleMapping.isBound(bidder, AgentID("late-bidder-7")));
+
+    roleMapping.clearExpectedAgents(bidder);
+    BOOST_REQUIRE(!roleMapping.isBound(bidder, AgentID("bidder-42")));
+    BOOST_REQUIRE(roleMapping.isExpected(bidder, AgentID("bidder-100")));
+}
+
 BOOST_AUTO_TEST_CASE(statemachine_reader_test)
 {
     using namespace fipa::acl;
@@ -419,6 +485,16 @@ BOOST_AUTO_TEST_CASE(statemachine_test_request)
             msg.setProtocol("");
         }
 
+        {
+            // Non-throwing variant leaves the state machine unchanged
+            ACLMessage msg(ACLMessage::REFUSE);
+            msg.setSender(other);
+            msg.addReceiver(self);
+            msg.setProtocol("other-protocol");
+            BOOST_REQUIRE(!request.tryConsumeMessage(msg));
+            BOOST_REQUIRE(request.getCurrentStateId() == "2");
+        }
+
         {
             ACLMessage msg(ACLMessage::REFUSE);
             msg.setSender(self);
@@ -546,5 +622,86 @@ BOOST_AUTO_TEST_CASE(statemachine_test_request)
     }
 
 }
+
+static void writeProtocol(const boost::filesystem::path& file, const std::string& performative)
+{
+    std::ofstream out(file.string().c_str());
+    out << "<scxml version=\"1.0\" initial=\"1\">" << std::endl;
+    out << "    <state id=\"1\">" << std::endl;
+    out << "        <transition performative=\"" << performative << "\" from=\"initiator\" to=\"B\" target=\"2\"/>" << std::endl;
+    out << "    </state>" << std::endl;
+    out << "    <state id=\"2\" final=\"yes\">" << std::endl;
+    out << "    </state>" << std::endl;
+    out << "</scxml>" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(statemachine_factory_reload)
+{
+    using namespace fipa::acl;
+    namespace fs = boost::filesystem;
+
+    fs::path directory = fs::temp_directory_path() / fs::unique_path("fipa_acl-protocols-%%%%-%%%%");
+    fs::create_directories(directory);
+    fs::path protocol = directory / "hot_reload";
+    writeProtocol(protocol, "inform");
+
+    ACLMessage informMsg(ACLMessage::INFORM);
+    ACLMessage requestMsg(ACLMessage::REQUEST);
+
+    StateMachineFactory::setProtocolResourceDir(directory.string());
+    StateMachine running = StateMachineFactory::getStateMachine("hot_reload");
+    BOOST_REQUIRE_MESSAGE(!StateMachineFactory::reload(), "Reload without changes");
+
+    writeProtocol(protocol, "request");
+    BOOST_REQUIRE_MESSAGE(StateMachineFactory::reload(), "Reload after change");
+    {
+        // Running conversations keep the previous version
+        BOOST_REQUIRE_NO_THROW(running.consumeMessage(informMsg));
+
+        StateMachine updated = StateMachineFactory::getStateMachine("hot_reload");
+        BOOST_REQUIRE_THROW(updated.consumeMessage(informMsg), std::runtime_error);
+        updated = StateMachineFactory::getStateMachine("hot_reload");
+        BOOST_REQUIRE_NO_THROW(updated.consumeMessage(requestMsg));
+    }
+
+    {
+        // A broken update keeps the previous version
+        std::ofstream out(protocol.string().c_str());
+        out << "<scxml version=\"1.0\" initial=\"1\"> <state";
+        out.close();
+        StateMachineFactory::reload();
+
+        StateMachine updated = StateMachineFactory::getStateMachine("hot_reload");
+        BOOST_REQUIRE_NO_THROW(updated.consumeMessage(requestMsg));
+    }
+
+    fs::remove(protocol);
+    BOOST_REQUIRE(StateMachineFactory::reload());
+    BOOST_REQUIRE_THROW(StateMachineFactory::getStateMachine("hot_reload"), std::runtime_error);
+
+    {
+        StateMachineFactory::startWatching(10);
+        BOOST_REQUIRE(StateMachineFactory::isWatching());
+        writeProtocol(protocol, "inform");
+
+        bool reloaded = false;
+        for(int i = 0; i < 200 && !reloaded; ++i)
+        {
+            boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+            try {
+                StateMachine updated = StateMachineFactory::getStateMachine("hot_reload");
+                reloaded = true;
+            } catch(const std::runtime_error& e)
+            {}
+        }
+        StateMachineFactory::stopWatching();
+        BOOST_REQUIRE(!StateMachineFactory::isWatching());
+        BOOST_REQUIRE_MESSAGE(reloaded, "Watcher picked up the new protocol");
+    }
+
+    fs::remove_all(directory);
+    StateMachineFactory::setProtocolResourceDir(getProtocolPath());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
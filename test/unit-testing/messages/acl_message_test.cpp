@@ -3,6 +3,7 @@
 #include <iostream>
 #include <fstream>
 #include <fipa_acl/bitefficient_message.h>
+#include <fipa_acl/message_generator/word_validation.h>
 
 using namespace std;
 using namespace fipa::acl;
@@ -227,5 +228,33 @@ BOOST_AUTO_TEST_CASE(message_test)
     AgentEqTest();
 }
 
+BOOST_AUTO_TEST_CASE(word_validation_test)
+{
+    // Compare against the character sets for all positions within and after a vectorized block
+    const char testChars[] = { 'a', 'Z', '(', ')', ' ', 0x00, '@', '#', '-', '5', '*', '\x7f', '\xff' };
+    for(size_t length = 0; length < 40; ++length)
+    {
+        for(size_t position = 0; position < length; ++position)
+        {
+            for(size_t c = 0; c < sizeof(testChars); ++c)
+            {
+                std::string text(length, 'x');
+                text[position] = testChars[c];
+
+                bool expected = text.find_first_of(illegalWordChars) == std::string::npos
+                    && illegalWordStart.find_first_of(text[0]) == std::string::npos;
+                BOOST_REQUIRE_MESSAGE(word::isValid(text) == expected, "Validation of word of length " << length << " with char " << int(testChars[c]) << " at " << position);
+
+                size_t illegalPosition = text.find_first_of(illegalWordChars);
+                size_t expectedPosition = illegalPosition == std::string::npos ? length : illegalPosition;
+                BOOST_REQUIRE(word::findIllegalChar(text.data(), text.size()) == expectedPosition);
+            }
+        }
+    }
+    BOOST_REQUIRE(word::isValid(""));
+    BOOST_REQUIRE(word::isValid(std::string(10000, 'a')));
+    BOOST_REQUIRE(!word::isValid(std::string(10000, 'a') + ")"));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
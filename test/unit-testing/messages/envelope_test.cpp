@@ -1,6 +1,9 @@
 #include <boost/test/auto_unit_test.hpp>
 #include <fipa_acl/fipa_acl.h>
+#include <fipa_acl/journal.h>
 #include <fipa_acl/message_generator/envelope_generator.h>
+#include <fipa_acl/message_generator/id_generator.h>
+#include <fipa_acl/message_generator/deduplication_cache.h>
 #include <fipa_acl/message_generator/format/bitefficient_format.h>
 #include <fipa_acl/message_generator/format/bitefficient_envelope_format.h>
 #include <fipa_acl/message_generator/format/xml_format.h>
@@ -9,6 +12,14 @@
 #include <fipa_acl/message_parser/grammar/grammar_bitefficient_envelope.h>
 #include "test_utils.h"
 #include <base/Time.hpp>
+#include <boost/thread.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <cstring>
+#include <set>
+#include <unistd.h>
+#include <sys/wait.h>
 
 BOOST_AUTO_TEST_SUITE(fipa_envelope_test_suite)
 
@@ -65,6 +76,132 @@ BOOST_AUTO_TEST_CASE(envelope_stamping_test)
     }
 }
 
+/**
+ * Create a number of ids
+ */
+static void createIds(std::vector<std::string>* ids, size_t count)
+{
+    for(size_t i = 0; i < count; ++i)
+    {
+        ids->push_back(fipa::acl::IDGenerator::createLocalId());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(id_generator_test)
+{
+    using namespace fipa::acl;
+
+    // Unique ids when created concurrently
+    {
+        const size_t numberOfThreads = 8;
+        const size_t idsPerThread = 10000;
+
+        std::vector< std::vector<std::string> > ids(numberOfThreads);
+        boost::thread_group threads;
+        for(size_t i = 0; i < numberOfThreads; ++i)
+        {
+            threads.create_thread(boost::bind(&createIds, &ids[i], idsPerThread));
+        }
+        threads.join_all();
+
+        std::set<std::string> uniqueIds;
+        for(size_t i = 0; i < numberOfThreads; ++i)
+        {
+            BOOST_REQUIRE(ids[i].size() == idsPerThread);
+            uniqueIds.insert(ids[i].begin(), ids[i].end());
+        }
+        BOOST_REQUIRE_MESSAGE(uniqueIds.size() == numberOfThreads*idsPerThread, "Unique ids: " << uniqueIds.size() << " expected " << numberOfThreads*idsPerThread);
+
+        std::string id = IDGenerator::createId();
+        BOOST_REQUIRE_MESSAGE(id.find(IDGenerator::getPrefix()) == 0, "Id '" << id << "' starts with prefix '" << IDGenerator::getPrefix() << "'");
+    }
+
+    // Forked child uses a different prefix
+    {
+        std::string parentPrefix = IDGenerator::getPrefix();
+        std::string parentId = IDGenerator::createId();
+
+        int fds[2];
+        BOOST_REQUIRE(pipe(fds) == 0);
+        pid_t pid = fork();
+        BOOST_REQUIRE(pid >= 0);
+        if(pid == 0)
+        {
+            close(fds[0]);
+            std::string childId = IDGenerator::createId();
+            ssize_t written = write(fds[1], childId.c_str(), childId.size());
+            close(fds[1]);
+            _exit(written == static_cast<ssize_t>(childId.size()) ? 0 : 1);
+        }
+        close(fds[1]);
+        char buffer[256];
+        ssize_t size = read(fds[0], buffer, sizeof(buffer));
+        close(fds[0]);
+        int status;
+        waitpid(pid, &status, 0);
+
+        BOOST_REQUIRE(size > 0);
+        std::string childId(buffer, size);
+        BOOST_REQUIRE_MESSAGE(childId.find(parentPrefix) != 0, "Child id '" << childId << "' does not use parent prefix '" << parentPrefix << "'");
+        BOOST_REQUIRE(childId != parentId);
+        BOOST_REQUIRE(IDGenerator::getPrefix() == parentPrefix);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(deduplication_cache_test)
+{
+    using namespace fipa::acl;
+
+    ACLMessage msg;
+    msg.setPerformative(ACLMessage::INFORM);
+    msg.setSender(AgentID("sender"));
+    msg.addReceiver(AgentID("receiver"));
+    msg.setContent("content");
+
+    ACLEnvelope letter(msg, representation::BITEFFICIENT);
+    base::Time date = base::Time::fromSeconds(1000);
+    ACLBaseEnvelope baseEnvelope = letter.getBaseEnvelope();
+    baseEnvelope.setDate(date);
+    letter.setBaseEnvelope(baseEnvelope);
+
+    // Same letter relayed along a different path
+    ACLEnvelope relayedLetter = letter;
+    relayedLetter.stamp(AgentID("mts-0"));
+    BOOST_REQUIRE(DeduplicationCache::computeHash(letter) == DeduplicationCache::computeHash(relayedLetter));
+
+    ACLEnvelope otherLetter = letter;
+    otherLetter.setPayload(letter.getPayload() + " ");
+    BOOST_REQUIRE(DeduplicationCache::computeHash(letter) != DeduplicationCache::computeHash(otherLetter));
+
+    base::Time now = base::Time::fromSeconds(2000);
+    {
+        DeduplicationCache cache(10, base::Time::fromSeconds(60));
+        BOOST_REQUIRE(!cache.isDuplicate(letter, now));
+        BOOST_REQUIRE(cache.isDuplicate(relayedLetter, now + base::Time::fromSeconds(1)));
+        BOOST_REQUIRE(!cache.isDuplicate(otherLetter, now + base::Time::fromSeconds(1)));
+        BOOST_REQUIRE(cache.size() == 2);
+
+        // Expired after time window
+        BOOST_REQUIRE(!cache.isDuplicate(letter, now + base::Time::fromSeconds(120)));
+        BOOST_REQUIRE(cache.size() == 1);
+
+        cache.clear();
+        BOOST_REQUIRE(cache.size() == 0);
+        BOOST_REQUIRE(!cache.isDuplicate(letter, now));
+    }
+
+    // Bounded number of entries
+    {
+        DeduplicationCache cache(2, base::Time::fromSeconds(60));
+        BOOST_REQUIRE(!cache.isDuplicate(1, now));
+        BOOST_REQUIRE(!cache.isDuplicate(2, now));
+        BOOST_REQUIRE(!cache.isDuplicate(3, now));
+        BOOST_REQUIRE(cache.size() == 2);
+        BOOST_REQUIRE(cache.isDuplicate(3, now));
+        BOOST_REQUIRE(!cache.isDuplicate(1, now));
+    }
+}
+
 BOOST_AUTO_TEST_CASE(grammar_test)
 {
     using namespace fipa::acl;
@@ -244,6 +381,229 @@ BOOST_AUTO_TEST_CASE(envelope_bitefficient_test)
 
 }
 
+BOOST_AUTO_TEST_CASE(letter_stream_decoder_test)
+{
+    using namespace fipa::acl;
+
+    // Letters with a varying number of extra envelopes and payload sizes
+    std::vector<std::string> letters;
+    std::string stream;
+    for(int i = 0; i < 5; ++i)
+    {
+        ACLMessage msg(ACLMessage::INFORM);
+        msg.setSender(AgentID("sender"));
+        msg.addReceiver(AgentID("receiver"));
+        msg.setContent(std::string(i*100, 'a' + i));
+
+        ACLEnvelope envelope(msg, representation::BITEFFICIENT);
+        for(int hop = 0; hop < i; ++hop)
+        {
+            envelope.stamp(AgentID("hop-" + boost::lexical_cast<std::string>(hop)));
+        }
+        letters.push_back(EnvelopeGenerator::create(envelope, representation::BITEFFICIENT));
+        stream += letters.back();
+    }
+
+    size_t chunkSizes[] = { 1, 7, 4096 };
+    for(size_t c = 0; c < sizeof(chunkSizes)/sizeof(size_t); ++c)
+    {
+        LetterStreamDecoder decoder(16);
+        std::vector<ACLEnvelope> decoded;
+        for(size_t offset = 0; offset < stream.size(); offset += chunkSizes[c])
+        {
+            decoder.push(stream.substr(offset, chunkSizes[c]));
+            ACLEnvelope letter;
+            while(decoder.next(letter))
+            {
+                decoded.push_back(letter);
+            }
+        }
+        BOOST_REQUIRE_MESSAGE(decoded.size() == letters.size(), "Chunk size " << chunkSizes[c] << ": decoded " << decoded.size() << " letters");
+        BOOST_REQUIRE(decoder.getBufferedSize() == 0);
+
+        for(size_t i = 0; i < letters.size(); ++i)
+        {
+            ACLEnvelope expected;
+            BOOST_REQUIRE(EnvelopeParser::parseData(letters[i], expected, representation::BITEFFICIENT));
+            BOOST_REQUIRE(decoded[i].getPayload() == expected.getPayload());
+            BOOST_REQUIRE(decoded[i].getExtraEnvelopes().size() == i);
+            BOOST_REQUIRE(decoded[i].getDeliveryPathString() == expected.getDeliveryPathString());
+            BOOST_REQUIRE(decoded[i].getACLMessage() == expected.getACLMessage());
+        }
+    }
+
+    // Raw letters, read directly into the buffer
+    {
+        LetterStreamDecoder decoder;
+        char* buffer = decoder.prepare(stream.size());
+        memcpy(buffer, stream.data(), stream.size() - 1);
+        decoder.commit(stream.size() - 1);
+
+        std::string letter;
+        for(size_t i = 0; i < letters.size() - 1; ++i)
+        {
+            BOOST_REQUIRE(decoder.next(letter));
+            BOOST_REQUIRE(letter == letters[i]);
+        }
+        BOOST_REQUIRE(!decoder.next(letter));
+        decoder.push(stream.substr(stream.size() - 1));
+        BOOST_REQUIRE(decoder.next(letter));
+        BOOST_REQUIRE(letter == letters.back());
+        BOOST_REQUIRE(!decoder.next(letter));
+    }
+
+    // Malformed stream
+    {
+        LetterStreamDecoder decoder;
+        decoder.push(letters[0]);
+        decoder.push(std::string("garbage"));
+        std::string letter;
+        BOOST_REQUIRE(decoder.next(letter));
+        BOOST_REQUIRE_THROW(decoder.next(letter), std::runtime_error);
+        decoder.clear();
+        BOOST_REQUIRE(decoder.getBufferedSize() == 0);
+    }
+
+    // Letter exceeding the size limit
+    {
+        ParserLimits defaultLimits = ParserLimits::getDefault();
+        ParserLimits limits;
+        limits.setMaxMessageSize(letters[4].size() - 1);
+        ParserLimits::setDefault(limits);
+
+        LetterStreamDecoder decoder;
+        decoder.push(letters[4]);
+        std::string letter;
+        BOOST_CHECK_THROW(decoder.next(letter), std::runtime_error);
+        ParserLimits::setDefault(defaultLimits);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(journal_test)
+{
+    using namespace fipa::acl;
+    namespace fs = boost::filesystem;
+
+    char tmpl[] = "/tmp/fipa_acl-journal-XXXXXX";
+    BOOST_REQUIRE(mkdtemp(tmpl));
+    std::string directory(tmpl);
+
+    base::Time start = base::Time::fromSeconds(1000);
+    std::vector<std::string> payloads;
+    {
+        // Small segments, so that letters are spread across several segments
+        JournalWriter writer(directory, 512);
+        for(int i = 0; i < 30; ++i)
+        {
+            ACLMessage msg(ACLMessage::INFORM);
+            msg.setSender(AgentID("sender"));
+            msg.addReceiver(AgentID("receiver"));
+            msg.setConversationID("conversation-" + boost::lexical_cast<std::string>(i % 3));
+            msg.setContent("content-" + boost::lexical_cast<std::string>(i));
+
+            ACLEnvelope envelope(msg, representation::BITEFFICIENT);
+            fipa::SerializedLetter letter(envelope, representation::BITEFFICIENT);
+            letter.timestamp = start + base::Time::fromSeconds(i);
+            writer.append(letter, msg.getConversationID());
+            payloads.push_back(envelope.getPayload());
+        }
+    }
+    {
+        // Continue the existing journal
+        JournalWriter writer(directory);
+        ACLMessage msg(ACLMessage::REQUEST);
+        msg.setConversationID("conversation-other");
+        writer.append(ACLEnvelope(msg, representation::BITEFFICIENT), representation::XML);
+    }
+
+    {
+        JournalReader reader(directory);
+        BOOST_REQUIRE_EQUAL(reader.size(), 31);
+        BOOST_REQUIRE_EQUAL(reader.getConversationIDs().size(), 4);
+
+        std::vector<JournalRecord> records = reader.getConversation("conversation-1");
+        BOOST_REQUIRE_EQUAL(records.size(), 10);
+        for(size_t i = 0; i < records.size(); ++i)
+        {
+            BOOST_REQUIRE(records[i].getRepresentation() == representation::BITEFFICIENT);
+            BOOST_REQUIRE(records[i].getTimestamp() == start + base::Time::fromSeconds(static_cast<int>(3*i + 1)));
+            BOOST_REQUIRE_EQUAL(records[i].getConversationID(), "conversation-1");
+            Letter letter = records[i].deserialize();
+            BOOST_REQUIRE(letter.getPayload() == payloads[3*i + 1]);
+        }
+
+        records = reader.getRecords(start + base::Time::fromSeconds(5), start + base::Time::fromSeconds(9));
+        BOOST_REQUIRE_EQUAL(records.size(), 5);
+        BOOST_REQUIRE(records.front().getTimestamp() == start + base::Time::fromSeconds(5));
+
+        const JournalRecord& last = reader.getRecord(30);
+        BOOST_REQUIRE(last.getRepresentation() == representation::XML);
+        BOOST_REQUIRE(last.deserialize().getACLMessage().getPerformative() == "request");
+        BOOST_REQUIRE(reader.getConversation("unknown").empty());
+    }
+
+    // Recover records without index and ignore an incomplete record
+    {
+        fs::remove(fs::path(directory) / "segment-00000000.index");
+        std::ofstream segment((directory + "/segment-00000001.journal").c_str(), std::ios::binary | std::ios::app);
+        segment.write("\x00\x00\x01", 3);
+        segment.close();
+
+        JournalReader reader(directory);
+        BOOST_REQUIRE_EQUAL(reader.size(), 31);
+        BOOST_REQUIRE_EQUAL(reader.getConversation("conversation-0").size(), 10);
+    }
+
+    fs::remove_all(fs::path(directory));
+}
+
+BOOST_AUTO_TEST_CASE(transcoder_test)
+{
+    using namespace fipa::acl;
+
+    ACLMessage msg(ACLMessage::QUERY_IF);
+    msg.setSender(AgentID("sender"));
+    msg.addReceiver(AgentID("receiver"));
+    msg.setConversationID("transcoding");
+    msg.setProtocol("query");
+    msg.setContent("transcoded content");
+
+    representation::Type types[] = { representation::BITEFFICIENT, representation::STRING_REP, representation::XML };
+    size_t numberOfTypes = sizeof(types)/sizeof(representation::Type);
+    for(size_t s = 0; s < numberOfTypes; ++s)
+    {
+        std::string source = MessageGenerator::create(msg, types[s]);
+        for(size_t t = 0; t < numberOfTypes; ++t)
+        {
+            std::string target;
+            BOOST_REQUIRE(Transcoder::transcode(source, types[s], target, types[t]));
+            BOOST_REQUIRE_MESSAGE(target == MessageGenerator::create(msg, types[t]),
+                    "Transcoding from " << representation::TypeTxt[types[s]] << " to " << representation::TypeTxt[types[t]]);
+        }
+    }
+
+    std::string target;
+    BOOST_REQUIRE(!Transcoder::transcode("garbage", representation::AUTO, target, representation::XML));
+
+    // Letter with an extra envelope which overrides the representation
+    ACLEnvelope letter(msg, representation::XML);
+    ACLBaseEnvelope extraEnvelope;
+    extraEnvelope.setACLRepresentation(representation::XML);
+    extraEnvelope.setPayloadLength(letter.getPayload().size());
+    letter.addExtraEnvelope(extraEnvelope);
+
+    BOOST_REQUIRE(Transcoder::transcode(letter, representation::BITEFFICIENT));
+    BOOST_REQUIRE(letter.getPayload() == MessageGenerator::create(msg, representation::BITEFFICIENT));
+    BOOST_REQUIRE(letter.flattened().getACLRepresentation() == representation::BITEFFICIENT);
+    BOOST_REQUIRE(letter.flattened().getPayloadLength() == letter.getPayload().size());
+    BOOST_REQUIRE(letter.getBaseEnvelope().getPayloadLength() == letter.getPayload().size());
+
+    std::string encodedLetter = EnvelopeGenerator::create(letter, representation::BITEFFICIENT);
+    ACLEnvelope decodedLetter;
+    BOOST_REQUIRE(EnvelopeParser::parseData(encodedLetter, decodedLetter, representation::BITEFFICIENT));
+    BOOST_REQUIRE(decodedLetter.getACLMessage() == msg);
+}
+
 BOOST_AUTO_TEST_CASE(envelope_xml_test)
 {
     using namespace fipa::acl;
@@ -5,14 +5,68 @@
 #include <fipa_acl/message_generator/format/bitefficient_format.h>
 
 #include <fipa_acl/message_parser/grammar/grammar_string_message.h>
+#include <fipa_acl/message_parser/string_message_parser.h>
+#include <fipa_acl/message_parser/envelope_parser.h>
+#include <fipa_acl/message_parser/parser_limits.h>
+#include <fipa_acl/message_parser/representation_detector.h>
+#include <fipa_acl/message_generator/envelope_generator.h>
 
 #include <string>
 #include <limits>
+#include <stdlib.h>
+#include <ctime>
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
 
 #include "test_utils.h"
 
 BOOST_AUTO_TEST_SUITE(fipa_message_test_suite)
 
+/**
+ * Reference encoding of the bitefficient date through the string representation
+ */
+static std::string getStringBasedBinDate(const base::Time& baseTime)
+{
+    std::string time = baseTime.toString(base::Time::Milliseconds);
+    boost::erase_all(time,":");
+    boost::erase_all(time,"-");
+    time.insert(14,sizeof(char),'0');
+    return fipa::acl::BitefficientFormat::getBinDate(time);
+}
+
+/**
+ * Check encoding against the string based encoding and decoding of the encoded date
+ * \param ambiguous set if the local time is ambiguous, i.e. within the hour repeated at the end of daylight saving time
+ * \param expectedDate expected date as YYYYMMDDhhmmss0mmm, if empty the string based encoding is used as reference
+ */
+static void checkBinDateRoundtrip(const base::Time& baseTime, bool ambiguous = false, const std::string& expectedDate = "")
+{
+    // resolution of the encoding is milliseconds
+    int64_t usecs = baseTime.toMicroseconds();
+    int64_t msecs = usecs / 1000;
+    if(usecs < 0 && usecs % 1000 != 0)
+    {
+        --msecs;
+    }
+    base::Time expectedTime = base::Time::fromMicroseconds(msecs*1000);
+
+    std::string generated = fipa::acl::BitefficientFormat::getBinDate(baseTime);
+    std::string expected = expectedDate.empty() ? getStringBasedBinDate(expectedTime) : fipa::acl::BitefficientFormat::getBinDate(expectedDate);
+    BOOST_REQUIRE_MESSAGE(generated == expected, "DateTime Generator for " << baseTime.toString(base::Time::Microseconds) << " differs from string based encoding");
+
+    fipa::acl::DateTime dateTime;
+    dateTime.dateTime = testGrammar<fipa::acl::grammar::DateTime, fipa::acl::Time>(generated, true, "DateTime -- roundtrip");
+
+    base::Time decodedTime;
+    BOOST_REQUIRE(fipa::acl::DateTime::decodeBinDate(reinterpret_cast<const unsigned char*>(generated.data()), generated.size(), decodedTime));
+    BOOST_REQUIRE_MESSAGE(decodedTime == dateTime.toTime(), "DateTime direct decoding " << decodedTime.toString(base::Time::Milliseconds) << " vs. " << dateTime.toTime().toString(base::Time::Milliseconds));
+
+    base::Time oneHour = base::Time::fromMicroseconds(3600*1000000LL);
+    bool matches = decodedTime == expectedTime
+        || (ambiguous && (decodedTime == expectedTime + oneHour || decodedTime == expectedTime - oneHour));
+    BOOST_REQUIRE_MESSAGE(matches, "DateTime roundtrip is " << decodedTime.toString(base::Time::Milliseconds) << " expected " << expectedTime.toString(base::Time::Milliseconds));
+}
+
 BOOST_AUTO_TEST_CASE(grammar_test)
 {
         namespace fab = fipa::acl::bitefficient;
@@ -447,6 +501,98 @@ BOOST_AUTO_TEST_CASE(grammar_test)
 }
 
 
+BOOST_AUTO_TEST_CASE(bin_date_codec_test)
+{
+    namespace fag = fipa::acl::grammar;
+
+    // Milliseconds
+    {
+        std::string times[] = { "20130101-12:59:59:020", "19991231-23:59:59:999", "20000229-00:00:00:000", "20370101-07:08:09:100" };
+        for(size_t i = 0; i < 4; ++i)
+        {
+            checkBinDateRoundtrip(base::Time::fromString(times[i], base::Time::Milliseconds));
+        }
+    }
+    // Sub-millisecond fraction is truncated
+    {
+        base::Time baseTime = base::Time::fromString("20130101-12:59:59:020", base::Time::Milliseconds);
+        checkBinDateRoundtrip(baseTime + base::Time::fromMicroseconds(999));
+    }
+    // Before 1970, i.e. negative microseconds
+    // (base::Time::toString does not support fractions of negative times, so the
+    // string based encoding cannot serve as reference)
+    {
+        base::Time baseTime = base::Time::fromString("19690615-13:14:15:250", base::Time::Milliseconds);
+        BOOST_REQUIRE(baseTime.toMicroseconds() < 0);
+        checkBinDateRoundtrip(baseTime, false, "196906151314150250");
+        checkBinDateRoundtrip(baseTime + base::Time::fromMicroseconds(456), false, "196906151314150250");
+    }
+    // Around daylight saving time changes
+    {
+        const char* tz = getenv("TZ");
+        std::string previousTZ = tz ? tz : "";
+        setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+        tzset();
+        fipa::acl::DateTime::resetUTCOffsetCache();
+
+        // 2013-03-31 01:00:00 UTC: 02:00 CET -> 03:00 CEST
+        // 2013-10-27 01:00:00 UTC: 03:00 CEST -> 02:00 CET
+        int64_t transitions[] = { 1364691600LL, 1382835600LL };
+        for(size_t t = 0; t < 2; ++t)
+        {
+            for(int64_t offset = -7200; offset <= 7200; offset += 7*60 + 13)
+            {
+                int64_t utcSeconds = transitions[t] + offset;
+                // the local hour before the end of daylight saving time is repeated
+                bool ambiguous = t == 1 && utcSeconds >= transitions[t] - 3600 && utcSeconds < transitions[t] + 3600;
+                checkBinDateRoundtrip(base::Time::fromMicroseconds(utcSeconds*1000000 + 123456), ambiguous);
+            }
+        }
+
+        if(tz)
+        {
+            setenv("TZ", previousTZ.c_str(), 1);
+        } else {
+            unsetenv("TZ");
+        }
+        tzset();
+        fipa::acl::DateTime::resetUTCOffsetCache();
+    }
+    // Only coded digits and valid fields are allowed
+    {
+        std::string valid = fipa::acl::BitefficientFormat::getBinDate(base::Time::fromString("20130101-12:59:59:020", base::Time::Milliseconds));
+        testGrammar<fag::DateTime, fipa::acl::Time>(valid, true, "DateTime -- valid");
+
+        // index of the byte and invalid value
+        int invalid[][2] = {
+            { 3, 0x1c }, // no digit
+            { 2, 0x11 }, // month 00
+            { 2, 0x24 }, // month 13
+            { 3, 0x11 }, // day 00
+            { 3, 0x43 }, // day 32
+            { 4, 0x35 }, // hour 24
+            { 5, 0x71 }, // minute 60
+            { 6, 0x71 }, // second 60
+            { 7, 0x21 }  // millisecond 1000
+        };
+        for(size_t i = 0; i < sizeof(invalid)/sizeof(invalid[0]); ++i)
+        {
+            std::string storage = valid;
+            storage[invalid[i][0]] = char(invalid[i][1]);
+            testFailGrammar<fag::DateTime, fipa::acl::Time>(storage, "DateTime -- invalid field");
+
+            base::Time decodedTime;
+            BOOST_REQUIRE(!fipa::acl::DateTime::decodeBinDate(reinterpret_cast<const unsigned char*>(storage.data()), storage.size(), decodedTime));
+        }
+
+        // day 29 in february of a non-leap year
+        std::string storage = fipa::acl::BitefficientFormat::getBinDate(base::Time::fromString("20130228-12:00:00:000", base::Time::Milliseconds));
+        storage[3] = char(0x3a);
+        testFailGrammar<fag::DateTime, fipa::acl::Time>(storage, "DateTime -- february 29th");
+    }
+}
+
+
 BOOST_AUTO_TEST_CASE(message_test)
 {
     using namespace fipa::acl;
@@ -509,6 +655,62 @@ BOOST_AUTO_TEST_CASE(message_test)
     BOOST_REQUIRE_MESSAGE(outputMsg.getReplyBy() == msg.getReplyBy(), "ReplyBy '" << outputMsg.getReplyBy().toString() << "' vs. msg " << msg.getReplyBy().toString());
     BOOST_REQUIRE_MESSAGE(outputMsg.getConversationID() == msg.getConversationID(), "ConversationID '" << outputMsg.getConversationID() << "' vs. input '" << msg.getConversationID() << "'");
     BOOST_REQUIRE_MESSAGE(outputMsg.getContent() == msg.getContent(), "Content '" << outputMsg.getContent() << "' vs. input '" << msg.getContent() << "'");
+
+    // The parser state is reused between messages, so a failed parse must not affect the next one
+    {
+        ACLMessage failedMsg;
+        BOOST_REQUIRE(!inputParser.parseData(encodedMsg.substr(0, encodedMsg.size()/2), failedMsg));
+
+        ACLMessage reparsedMsg;
+        BOOST_REQUIRE(inputParser.parseData(encodedMsg, reparsedMsg));
+        BOOST_REQUIRE(reparsedMsg.getAllReceivers() == outputMsg.getAllReceivers());
+        BOOST_REQUIRE(reparsedMsg.getContent() == outputMsg.getContent());
+        BOOST_REQUIRE(reparsedMsg.getUserdefParams().size() == outputMsg.getUserdefParams().size());
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(representation_detection_test)
+{
+    using namespace fipa::acl;
+
+    ACLMessage msg(ACLMessage::INFORM);
+    msg.setSender(AgentID("sender"));
+    msg.addReceiver(AgentID("receiver"));
+    msg.setConversationID("detection");
+    msg.setContent("detection content");
+
+    representation::Type types[] = { representation::BITEFFICIENT, representation::STRING_REP, representation::XML };
+    for(size_t i = 0; i < sizeof(types)/sizeof(representation::Type); ++i)
+    {
+        std::string encodedMsg = MessageGenerator::create(msg, types[i]);
+        BOOST_REQUIRE_MESSAGE(RepresentationDetector::detectMessage(encodedMsg) == types[i], "Detect " << representation::TypeTxt[types[i]]);
+
+        ACLMessage outputMsg;
+        BOOST_REQUIRE_MESSAGE(MessageParser::parseData(encodedMsg, outputMsg, representation::AUTO), "Parse " << representation::TypeTxt[types[i]]);
+        BOOST_REQUIRE(outputMsg.getContent() == msg.getContent());
+    }
+
+    representation::Type envelopeTypes[] = { representation::BITEFFICIENT, representation::XML };
+    for(size_t i = 0; i < sizeof(envelopeTypes)/sizeof(representation::Type); ++i)
+    {
+        ACLEnvelope envelope(msg, representation::STRING_REP);
+        std::string encodedEnvelope = EnvelopeGenerator::create(envelope, envelopeTypes[i]);
+        BOOST_REQUIRE(RepresentationDetector::detectEnvelope(encodedEnvelope) == envelopeTypes[i]);
+
+        ACLEnvelope outputEnvelope;
+        BOOST_REQUIRE(EnvelopeParser::parseData(encodedEnvelope, outputEnvelope, representation::AUTO));
+        BOOST_REQUIRE(outputEnvelope.getACLMessage().getContent() == msg.getContent());
+    }
+
+    BOOST_REQUIRE(RepresentationDetector::detectMessage(" \n (inform)") == representation::STRING_REP);
+    BOOST_REQUIRE(RepresentationDetector::detectMessage("\xef\xbb\xbf<?xml version=\"1.0\"?>") == representation::XML);
+    BOOST_REQUIRE(RepresentationDetector::detectMessage("") == representation::UNKNOWN);
+    BOOST_REQUIRE(RepresentationDetector::detectMessage("inform") == representation::UNKNOWN);
+    BOOST_REQUIRE(RepresentationDetector::detectEnvelope("(inform)") == representation::UNKNOWN);
+
+    ACLMessage outputMsg;
+    BOOST_REQUIRE(!MessageParser::parseData("garbage", outputMsg, representation::AUTO));
 }
 
 
@@ -599,6 +801,163 @@ BOOST_AUTO_TEST_CASE(binary_message_content)
 }
 
 
+BOOST_AUTO_TEST_CASE(large_content_test)
+{
+    using namespace fipa::acl;
+
+    ACLMessage msg(ACLMessage::INFORM);
+    msg.setSender(AgentID("sender"));
+    msg.addReceiver(AgentID("receiver"));
+
+    // Printable content is encoded as null terminated byte length encoded string
+    // in the bitefficient representation
+    std::string content(1000000, 'x');
+    content[0] = '"';
+    content[content.size() - 1] = '#';
+    msg.setContent(content);
+
+    MessageParser inputParser;
+    for(int i = representation::BITEFFICIENT; i < representation::END_MARKER; ++i)
+    {
+        representation::Type type = static_cast<representation::Type>(i);
+        std::string encodedMsg = MessageGenerator::create(msg, type);
+
+        ACLMessage outputMsg;
+        BOOST_REQUIRE_MESSAGE(inputParser.parseData(encodedMsg, outputMsg, type), "Parsing large content using " << representation::TypeTxt[type]);
+        BOOST_REQUIRE_MESSAGE(outputMsg.getContent() == content, "Large content preserved using " << representation::TypeTxt[type]);
+    }
+
+    // A length prefix which does not match the position of the terminator
+    // falls back to reading up to the terminator
+    {
+        msg.setContent("abcdef");
+        std::string encodedMsg = MessageGenerator::create(msg, representation::BITEFFICIENT);
+        size_t pos = encodedMsg.find("#6\"abcdef");
+        BOOST_REQUIRE(pos != std::string::npos);
+        encodedMsg[pos + 1] = '4';
+
+        ACLMessage outputMsg;
+        BOOST_REQUIRE(inputParser.parseData(encodedMsg, outputMsg, representation::BITEFFICIENT));
+        BOOST_REQUIRE_EQUAL(outputMsg.getContent(), "abcdef");
+    }
+
+    // Letter with large payload
+    {
+        msg.setContent(content);
+        ACLEnvelope envelope(msg, representation::BITEFFICIENT);
+        std::string encodedEnvelope = EnvelopeGenerator::create(envelope, representation::BITEFFICIENT);
+
+        ACLEnvelope outputEnvelope;
+        BOOST_REQUIRE(EnvelopeParser::parseData(encodedEnvelope, outputEnvelope, representation::BITEFFICIENT));
+        BOOST_REQUIRE(outputEnvelope.getPayload() == envelope.getPayload());
+        BOOST_REQUIRE(outputEnvelope.getACLMessage().getContent() == content);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(parser_limits_test)
+{
+    using namespace fipa::acl;
+
+    ACLMessage msg(ACLMessage::INFORM);
+    msg.setContent("content");
+
+    // Sender with resolvers nested 20 levels deep
+    AgentID sender("resolver-20");
+    for(int i = 19; i >= 0; --i)
+    {
+        AgentID agent("resolver-" + boost::lexical_cast<std::string>(i));
+        agent.addResolver(sender);
+        sender = agent;
+    }
+    msg.setSender(sender);
+    for(int i = 0; i < 5; ++i)
+    {
+        msg.addReceiver(AgentID("receiver-" + boost::lexical_cast<std::string>(i)));
+        msg.addUserdefParam(UserdefParam("param-" + boost::lexical_cast<std::string>(i), "value"));
+    }
+
+    representation::Type types[] = { representation::BITEFFICIENT, representation::XML };
+    for(size_t t = 0; t < sizeof(types)/sizeof(types[0]); ++t)
+    {
+        representation::Type type = types[t];
+        std::string encodedMsg;
+        if(type == representation::BITEFFICIENT)
+        {
+            // By default only the first level of resolvers is encoded
+            BitefficientMessageFormat format;
+            format.setResolverDepth(100);
+            encodedMsg = format.apply(msg);
+        } else {
+            encodedMsg = MessageGenerator::create(msg, type);
+        }
+        ACLMessage outputMsg;
+
+        ParserLimits limits = ParserLimits::unlimited();
+        ParserLimits::setDefault(limits);
+        BOOST_REQUIRE_MESSAGE(MessageParser::parseData(encodedMsg, outputMsg, type), "Parse without limits using " << representation::TypeTxt[type]);
+        BOOST_REQUIRE(outputMsg.getSender() == sender);
+
+        limits.setMaxResolverDepth(20);
+        ParserLimits::setDefault(limits);
+        BOOST_REQUIRE_MESSAGE(MessageParser::parseData(encodedMsg, outputMsg, type), "Parse with resolver depth at limit using " << representation::TypeTxt[type]);
+
+        limits.setMaxResolverDepth(19);
+        ParserLimits::setDefault(limits);
+        BOOST_REQUIRE_MESSAGE(!MessageParser::parseData(encodedMsg, outputMsg, type), "Reject resolver depth using " << representation::TypeTxt[type]);
+
+        limits = ParserLimits::unlimited();
+        limits.setMaxReceivers(4);
+        ParserLimits::setDefault(limits);
+        BOOST_REQUIRE_MESSAGE(!MessageParser::parseData(encodedMsg, outputMsg, type), "Reject number of receivers using " << representation::TypeTxt[type]);
+
+        limits = ParserLimits::unlimited();
+        limits.setMaxUserdefParams(4);
+        ParserLimits::setDefault(limits);
+        BOOST_REQUIRE_MESSAGE(!MessageParser::parseData(encodedMsg, outputMsg, type), "Reject number of user defined parameters using " << representation::TypeTxt[type]);
+
+        limits = ParserLimits::unlimited();
+        limits.setMaxMessageSize(encodedMsg.size() - 1);
+        ParserLimits::setDefault(limits);
+        BOOST_REQUIRE_MESSAGE(!MessageParser::parseData(encodedMsg, outputMsg, type), "Reject message size using " << representation::TypeTxt[type]);
+    }
+
+    // Letters
+    {
+        ACLEnvelope envelope(msg, representation::BITEFFICIENT);
+        ACLBaseEnvelope baseEnvelope = envelope.getBaseEnvelope();
+        baseEnvelope.setFrom(sender);
+        envelope.setBaseEnvelope(baseEnvelope);
+
+        representation::Type types[] = { representation::BITEFFICIENT, representation::XML };
+        for(size_t t = 0; t < sizeof(types)/sizeof(types[0]); ++t)
+        {
+            representation::Type type = types[t];
+            std::string encodedEnvelope = EnvelopeGenerator::create(envelope, type);
+            ACLEnvelope outputEnvelope;
+
+            ParserLimits limits = ParserLimits::unlimited();
+            ParserLimits::setDefault(limits);
+            BOOST_REQUIRE_MESSAGE(EnvelopeParser::parseData(encodedEnvelope, outputEnvelope, type), "Parse letter without limits using " << representation::TypeTxt[type]);
+
+            limits.setMaxResolverDepth(19);
+            ParserLimits::setDefault(limits);
+            BOOST_REQUIRE_MESSAGE(!EnvelopeParser::parseData(encodedEnvelope, outputEnvelope, type), "Reject letter resolver depth using " << representation::TypeTxt[type]);
+
+            limits = ParserLimits::unlimited();
+            limits.setMaxReceivers(4);
+            ParserLimits::setDefault(limits);
+            BOOST_REQUIRE_MESSAGE(!EnvelopeParser::parseData(encodedEnvelope, outputEnvelope, type), "Reject letter receivers using " << representation::TypeTxt[type]);
+
+            limits = ParserLimits::unlimited();
+            limits.setMaxMessageSize(encodedEnvelope.size() - 1);
+            ParserLimits::setDefault(limits);
+            BOOST_REQUIRE_MESSAGE(!EnvelopeParser::parseData(encodedEnvelope, outputEnvelope, type), "Reject letter size using " << representation::TypeTxt[type]);
+        }
+    }
+
+    ParserLimits::setDefault(ParserLimits());
+}
+
 BOOST_AUTO_TEST_CASE(string_grammar_test)
 {
 
@@ -793,6 +1152,93 @@ BOOST_AUTO_TEST_CASE(string_grammar_test)
 
 }
 
+/**
+ * Parse with the selected string parser implementation
+ * \return 1 if successful, 0 if parsing failed, -1 if an exception was thrown
+ */
+static int parseStringRep(const std::string& encodedMsg, fipa::acl::ACLMessage& msg, fipa::acl::string_parser::Type type)
+{
+    using namespace fipa::acl;
+    StringMessageParser::setImplementation(type);
+    try {
+        return MessageParser::parseData(encodedMsg, msg, representation::STRING_REP) ? 1 : 0;
+    } catch(const std::exception& e)
+    {
+        return -1;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(string_descent_parser_test)
+{
+    using namespace fipa::acl;
+
+    std::vector<std::string> corpus;
+    // Messages of string_grammar_test
+    corpus.push_back("(inform:sender(agent-identifier:nameAGENTNAME):content\"TESTCONTENT\")");
+    corpus.push_back("(inform\n\t:sender\n\t\t(agent-identifier\n\t\t\t:name AGENTNAME)\n\t:content \"TESTCONTENT\":encoding(custom_encoding))");
+    corpus.push_back("(INFORM\n :SENDER ( AGENT-IDENTIFIER  :NAME AGENTNAME )\n :receiver (SET ( agent-identifier  :name AGENTNAME2 ) )\n :content  \"TESTCONTENT\":conversation-id #6\"convid)");
+    // Expressions, numbers, escaped quotes and nested expressions
+    corpus.push_back("(request :content \"say \\\"hello\\\"\" :language ( fipa-sl ( 1.5e3 -2 ) ) :ontology 42 :reply-with .5)");
+    corpus.push_back("(request-whenever:receiver(set(agent-identifier:name a:addresses(sequence tcp://host:1 http://host:2 ):resolvers(sequence(agent-identifier:name r0)(agent-identifier:name r1)))(agent-identifier:name b :X-key(#3\"val))))");
+    corpus.push_back("(cfp:reply-by 20131128T200107123Z:in-reply-to():X-param((a)(#1\"b)))");
+    corpus.push_back("(agree:X-param(#1\"a)   )trailing");
+    corpus.push_back("(query-if:protocol fipa-query:content #0\")");
+    corpus.push_back(std::string("(inform:content #5\"a") + '\0' + "b()c)");
+    // Invalid messages
+    corpus.push_back("");
+    corpus.push_back("(unknown-performative)");
+    corpus.push_back("(inform:content #10\"short)");
+    corpus.push_back("(inform:content #99999999999\"x)");
+    corpus.push_back("(inform:sender(agent-identifier:name 1agent))");
+    corpus.push_back("(inform:receiver(set(agent-identifier:name a)");
+    corpus.push_back("(inform:reply-by 2013112T200107123)");
+    corpus.push_back("(inform:content \"unterminated)");
+    corpus.push_back("(inform:x-lowercase(a))");
+
+    // Messages generated by the encoder
+    {
+        ACLMessage msg(ACLMessage::REQUEST_WHEN);
+        msg.setContent("random content with (parentheses) and \"quotes\"");
+        msg.setReplyBy(base::Time::fromString("20131128-20:01:07:123", base::Time::Milliseconds));
+        msg.addReplyTo(AgentID("reply-to-0"));
+        msg.setInReplyTo("in-reply-to");
+        AgentID receiver("receiver-0");
+        receiver.addResolver(AgentID("resolver0"));
+        receiver.addAddress("http://Fritzmobil:7778/acc");
+        msg.addReceiver(receiver);
+        msg.addReceiver(AgentID("receiver-1"));
+        msg.setSender(AgentID("sender"));
+        msg.setOntology("test ontology");
+        msg.setLanguage("test language");
+        msg.setConversationID("conversation-id");
+        msg.setProtocol("protocol");
+        msg.setEncoding("encoding");
+        msg.addUserdefParam(UserdefParam("test-param","test-value"));
+        corpus.push_back(MessageGenerator::create(msg, representation::STRING_REP));
+
+        msg.setContent(std::string(100000, 'x'));
+        corpus.push_back(MessageGenerator::create(msg, representation::STRING_REP));
+    }
+
+    for(size_t i = 0; i < corpus.size(); ++i)
+    {
+        ACLMessage spiritMsg;
+        ACLMessage descentMsg;
+        int spiritResult = parseStringRep(corpus[i], spiritMsg, string_parser::SPIRIT);
+        int descentResult = parseStringRep(corpus[i], descentMsg, string_parser::DESCENT);
+
+        BOOST_REQUIRE_MESSAGE(spiritResult == descentResult, "Parse result differs: spirit: " << spiritResult << " descent: " << descentResult << " for '" << corpus[i] << "'");
+        if(spiritResult == 1)
+        {
+            BOOST_REQUIRE_MESSAGE(spiritMsg == descentMsg && spiritMsg.getUserdefParams() == descentMsg.getUserdefParams(),
+                    "Parsed message differs for '" << corpus[i] << "': spirit: " << spiritMsg.toString() << " descent: " << descentMsg.toString());
+        }
+    }
+    BOOST_REQUIRE(corpus.size() > 0);
+
+    StringMessageParser::setImplementation(string_parser::SPIRIT);
+}
+
 BOOST_AUTO_TEST_CASE(message_xml_test)
 {
     using namespace fipa::acl;